@@ -0,0 +1,742 @@
+/*
+ * End-to-end benchmark suite: runs the solver over families of generated
+ * graphs (node count, density, weight distribution and k sweeps) and
+ * records wall time, peak RSS, objective and a per-phase breakdown for
+ * every case. The order family solves clustered graphs with scrambled ids
+ * under each node reordering and reports the mean id gap of an edge and,
+ * where the kernel exposes hardware counters, cache misses. Results print
+ * as a table and can be written as JSON or CSV; two result files can be
+ * compared to catch throughput or quality regressions.
+ *
+ *   benchmark [--suite quick|full] [--filter TEXT] [--repeat N]
+ *             [--json FILE] [--csv FILE]
+ *   benchmark --compare OLD NEW [--tolerance FRACTION]
+ *
+ * Build with the solver's flags, e.g.
+ *   gcc -O2 -DMWCP_USE_PTHREADS -o benchmark benchmark.c -lm -lpthread
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define NO_EDGE -9999
+
+// Phase timings and counters come from the solver's own instrumentation
+#define MWCP_STATS
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BENCH_FORK
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#define BENCH_PERF
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#define WEIGHTS_UNIFORM 0       // uniform in [-100, 100]
+#define WEIGHTS_POSITIVE 1      // uniform in [1, 100]
+#define WEIGHTS_MIXED 2         // 80% small positive, 20% strongly negative
+#define WEIGHTS_HEAVY 3         // Pareto magnitudes, 30% negative
+#define WEIGHTS_TIES 4          // -1 or +1
+
+static const char* weight_names[] = { "uniform", "positive", "mixed", "heavy", "ties" };
+static const char* order_names[] = { "none", "degeneracy", "rcm", "community" };
+
+// Edge probability inside a planted cluster
+#define CLUSTER_DENSITY 0.5
+
+typedef struct {
+    const char* family;
+    int n;
+    double density;             // edge probability
+    int weights;
+    int k;
+    int full_only;              // skipped by the quick suite
+    int cluster;                // planted cluster size under scrambled ids, 0 for none
+    int order;                  // MWCP_ORDER_* relabeling before the solve
+} BenchCase;
+
+// Sparse cases keep the average degree fixed as n grows
+#define DEG(n, d) ((double)(d) / ((n) - 1))
+
+static const BenchCase cases[] = {
+    { "n",       100,   0.1,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       300,   0.1,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       1000,  0.1,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       3000,  0.1,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       1000,  DEG(1000, 16), WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       10000, DEG(10000, 16), WEIGHTS_UNIFORM, 5,  0, 0,  MWCP_ORDER_NONE },
+    { "n",       30000, DEG(30000, 16), WEIGHTS_UNIFORM, 5,  1, 0,  MWCP_ORDER_NONE },
+    { "n",       50000, DEG(50000, 16), WEIGHTS_UNIFORM, 5,  1, 0,  MWCP_ORDER_NONE },
+    { "density", 2000,  0.01,          WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "density", 2000,  0.05,          WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "density", 2000,  0.2,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "density", 2000,  0.5,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "density", 2000,  0.9,           WEIGHTS_UNIFORM,  5,  0, 0,  MWCP_ORDER_NONE },
+    { "density", 5000,  0.5,           WEIGHTS_UNIFORM,  5,  1, 0,  MWCP_ORDER_NONE },
+    { "weights", 2000,  0.2,           WEIGHTS_POSITIVE, 5,  0, 0,  MWCP_ORDER_NONE },
+    { "weights", 2000,  0.2,           WEIGHTS_MIXED,    5,  0, 0,  MWCP_ORDER_NONE },
+    { "weights", 2000,  0.2,           WEIGHTS_HEAVY,    5,  0, 0,  MWCP_ORDER_NONE },
+    { "weights", 2000,  0.2,           WEIGHTS_TIES,     5,  0, 0,  MWCP_ORDER_NONE },
+    { "k",       2000,  0.3,           WEIGHTS_UNIFORM,  2,  0, 0,  MWCP_ORDER_NONE },
+    { "k",       2000,  0.3,           WEIGHTS_UNIFORM,  3,  0, 0,  MWCP_ORDER_NONE },
+    { "k",       2000,  0.3,           WEIGHTS_UNIFORM,  8,  0, 0,  MWCP_ORDER_NONE },
+    { "k",       2000,  0.3,           WEIGHTS_UNIFORM,  16, 0, 0,  MWCP_ORDER_NONE },
+    { "k",       2000,  0.3,           WEIGHTS_UNIFORM,  64, 1, 0,  MWCP_ORDER_NONE },
+    { "order",   10000, DEG(10000, 8), WEIGHTS_MIXED,    5,  0, 40, MWCP_ORDER_NONE },
+    { "order",   10000, DEG(10000, 8), WEIGHTS_MIXED,    5,  0, 40, MWCP_ORDER_DEGENERACY },
+    { "order",   10000, DEG(10000, 8), WEIGHTS_MIXED,    5,  0, 40, MWCP_ORDER_RCM },
+    { "order",   10000, DEG(10000, 8), WEIGHTS_MIXED,    5,  0, 40, MWCP_ORDER_COMMUNITY },
+};
+
+typedef struct {
+    char name[64];
+    int n, k;
+    long long edges;
+    int cliques;
+    double objective;
+    double wall_ms;             // solve only, graph generation excluded
+    long long rss_kb;           // peak resident set, -1 if unknown
+    double edge_span;           // mean |id(u) - id(v)| over edges as the solver numbers them
+    long long cache_misses;     // during the solve, -1 if counters are unavailable
+    double phase_ms[MWCP_PHASE_COUNT];
+    MwcpStats stats;
+    int ok;
+} BenchResult;
+
+static void case_name(const BenchCase* c, char* out, size_t size) {
+    int len = snprintf(out, size, "%s/n=%d/p=%.4g/%s/k=%d", c->family, c->n, c->density, weight_names[c->weights], c->k);
+    if (c->cluster > 0 && len > 0 && (size_t)len < size) {
+        snprintf(out + len, size - (size_t)len, "/c=%d/%s", c->cluster, order_names[c->order]);
+    }
+}
+
+static int draw_weight(Rng* rng, int dist) {
+    uint64_t r = rng_next(rng);
+    switch (dist) {
+    case WEIGHTS_POSITIVE:
+        return 1 + (int)(r % 100);
+    case WEIGHTS_MIXED:
+        return (r >> 32) % 5 ? 1 + (int)(r % 20) : -1 - (int)(r % 100);
+    case WEIGHTS_HEAVY: {
+        // Pareto(alpha = 1.5) magnitude from the top 53 bits
+        double u = ((r >> 11) + 1) * (1.0 / 9007199254740992.0);
+        double m = 5.0 / pow(u, 1.0 / 1.5);
+        int w = m > 50000.0 ? 50000 : (int)m;
+        return (r & 0xFF) < 77 ? -(w > 5000 ? 5000 : w) : w;
+    }
+    case WEIGHTS_TIES:
+        return (r >> 40) & 1 ? 1 : -1;
+    default:
+        return (int)(r % 201) - 100;
+    }
+}
+
+/*
+ * Row u's neighbours above u, drawn with geometric skips so generation is
+ * O(edges). Each row has its own stream, so both passes see the same graph.
+ */
+typedef struct {
+    Rng rng;
+    double density;
+    double log_q;
+    int next;
+} RowSampler;
+
+static void row_sampler_init(RowSampler* s, const BenchCase* c, int u) {
+    rng_seed(&s->rng, 0x9E3779B97F4A7C15ULL * (uint64_t)(u + 1) ^ (uint64_t)c->n << 20 ^ (uint64_t)c->weights);
+    s->density = c->density;
+    s->log_q = c->density > 0.0 && c->density < 1.0 ? log(1.0 - c->density) : 0.0;
+    s->next = u;
+}
+
+static int row_sampler_next(RowSampler* s, int n) {
+    if (s->density >= 1.0) {
+        s->next++;
+    } else if (s->density <= 0.0) {
+        s->next = n;
+    } else {
+        double u = ((rng_next(&s->rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+        double skip = floor(log(u) / s->log_q);
+        s->next = skip >= (double)n ? n : s->next + 1 + (int)skip;
+    }
+    return s->next < n ? s->next : -1;
+}
+
+static int compare_edge_ids(const void* a, const void* b) {
+    const Edge* x = (const Edge*)a;
+    const Edge* y = (const Edge*)b;
+    if (x->u != y->u) return x->u < y->u ? -1 : 1;
+    return (x->v > y->v) - (x->v < y->v);
+}
+
+static int push_edge(Edge** edges, size_t* count, size_t* cap, int a, int b, int w) {
+    if (*count == *cap) {
+        Edge* grown = (Edge*)realloc(*edges, 2 * *cap * sizeof(Edge));
+        if (!grown) return 0;
+        *edges = grown;
+        *cap *= 2;
+    }
+    Edge* e = &(*edges)[(*count)++];
+    e->u = a < b ? a : b;
+    e->v = a < b ? b : a;
+    e->weight = w;
+    return 1;
+}
+
+/*
+ * Planted clusters of c->cluster consecutive nodes (edge probability
+ * CLUSTER_DENSITY inside) over a background of density c->density, with
+ * the ids then scrambled so that no cluster is contiguous
+ */
+static int generate_clustered(Graph* g, const BenchCase* c, long long* edge_count) {
+    int n = c->n;
+    Rng rng;
+    rng_seed(&rng, 0xC1D5u ^ (uint64_t)n << 20 ^ (uint64_t)c->cluster);
+    int* id = (int*)malloc((size_t)n * sizeof(int));
+    size_t cap = (size_t)n * 16;
+    Edge* edges = (Edge*)malloc(cap * sizeof(Edge));
+    size_t* degree = (size_t*)calloc((size_t)n + 1, sizeof(size_t));
+    int ok = id && edges && degree;
+    for (int i = 0; ok && i < n; i++) id[i] = i;
+    for (int i = n - 1; ok && i > 0; i--) {
+        int j = (int)(rng_next(&rng) % (uint64_t)(i + 1));
+        int t = id[i];
+        id[i] = id[j];
+        id[j] = t;
+    }
+
+    size_t count = 0;
+    RowSampler s;
+    for (int u = 0; ok && u < n - 1; u++) {
+        int end = (u / c->cluster + 1) * c->cluster;
+        for (int v = u + 1; ok && v < end && v < n; v++) {
+            if ((double)(rng_next(&rng) >> 11) * (1.0 / 9007199254740992.0) >= CLUSTER_DENSITY) continue;
+            ok = push_edge(&edges, &count, &cap, id[u], id[v], draw_weight(&rng, c->weights));
+        }
+        row_sampler_init(&s, c, u);
+        for (int v; ok && (v = row_sampler_next(&s, n)) >= 0; ) {
+            ok = push_edge(&edges, &count, &cap, id[u], id[v], draw_weight(&s.rng, c->weights));
+        }
+    }
+
+    // Ascending (u, v) for the sparse rows; a background edge repeating a cluster edge is dropped
+    size_t kept = 0;
+    if (ok) qsort(edges, count, sizeof(Edge), compare_edge_ids);
+    for (size_t i = 0; ok && i < count; i++) {
+        if (kept > 0 && edges[kept - 1].u == edges[i].u && edges[kept - 1].v == edges[i].v) continue;
+        edges[kept++] = edges[i];
+        degree[edges[i].u]++;
+        degree[edges[i].v]++;
+    }
+    *edge_count = (long long)kept;
+    ok = ok && graph_alloc_sparse(g, n, degree);
+    for (size_t i = 0; ok && i < kept; i++) {
+        graph_sparse_append(g, degree, edges[i].u, edges[i].v, edges[i].weight);
+    }
+    free(id);
+    free(edges);
+    free(degree);
+    return ok;
+}
+
+static int generate_graph(Graph* g, const BenchCase* c, long long* edge_count) {
+    int n = c->n;
+    if (c->cluster > 0) return generate_clustered(g, c, edge_count);
+    size_t* degree = (size_t*)calloc((size_t)n + 1, sizeof(size_t));
+    if (!degree) return 0;
+    long long edges = 0;
+    RowSampler s;
+    for (int u = 0; u < n - 1; u++) {
+        row_sampler_init(&s, c, u);
+        for (int v; (v = row_sampler_next(&s, n)) >= 0; ) {
+            draw_weight(&s.rng, c->weights);
+            degree[u]++;
+            degree[v]++;
+            edges++;
+        }
+    }
+    *edge_count = edges;
+
+    int ok;
+    if (graph_is_sparse(n, edges)) {
+        ok = graph_alloc_sparse(g, n, degree);
+        for (int u = 0; ok && u < n - 1; u++) {
+            row_sampler_init(&s, c, u);
+            for (int v; (v = row_sampler_next(&s, n)) >= 0; ) {
+                graph_sparse_append(g, degree, u, v, draw_weight(&s.rng, c->weights));
+            }
+        }
+    } else {
+        ok = graph_alloc(g, n);
+        for (int u = 0; ok && u < n; u++) {
+            int* row = graph_upper_row(g, u);
+            for (int j = 0; j < n - 1 - u; j++) {
+                row[j] = NO_EDGE;
+            }
+            if (u < n - 1) {
+                row_sampler_init(&s, c, u);
+                for (int v; (v = row_sampler_next(&s, n)) >= 0; ) {
+                    row[v - u - 1] = draw_weight(&s.rng, c->weights);
+                }
+            }
+            graph_finish_row(g, u, 0);
+        }
+    }
+    free(degree);
+    return ok;
+}
+
+static double partition_objective(const Graph* g, const PartitionArena* arena) {
+    long long total = 0;
+    for (int c = 0; c < arena->count; c++) {
+        const int* members = arena->members + arena->offsets[c];
+        int size = arena->offsets[c + 1] - arena->offsets[c];
+        for (int i = 0; i < size; i++) {
+            for (int j = i + 1; j < size; j++) {
+                total += graph_weight(g, members[i], members[j]);
+            }
+        }
+    }
+    return (double)total / g->n;
+}
+
+/*
+ * Mean id distance between the endpoints of an edge once `order` has
+ * relabeled the nodes: a proxy for how far apart in memory the rows and
+ * gain entries of neighbours are
+ */
+static double edge_span(const Graph* g, int order) {
+    int n = g->n;
+    int* perm = (int*)malloc((size_t)n * sizeof(int));
+    int* inv = (int*)malloc((size_t)n * sizeof(int));
+    double total = 0.0;
+    long long edges = 0;
+    if (perm && inv && node_order(g, order, perm)) {
+        for (int i = 0; i < n; i++) inv[perm[i]] = i;
+        for (int u = 0; u < n; u++) {
+            NeighbourIter it;
+            int v, w;
+            neighbour_iter_init(&it, g, u, u + 1);
+            while (neighbour_iter_next(&it, &v, &w)) {
+                total += inv[u] > inv[v] ? inv[u] - inv[v] : inv[v] - inv[u];
+                edges++;
+            }
+        }
+    }
+    free(perm);
+    free(inv);
+    return edges ? total / (double)edges : 0.0;
+}
+
+/*
+ * User-space cache-miss counter for this process and the threads it
+ * starts; -1 where the kernel (or a sandbox) provides none
+ */
+static int cache_counter_open(void) {
+#ifdef BENCH_PERF
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
+
+static long long cache_counter_close(int fd) {
+    long long misses = -1;
+#ifdef BENCH_PERF
+    if (fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != (ssize_t)sizeof(misses)) misses = -1;
+        close(fd);
+    }
+#else
+    (void)fd;
+#endif
+    return misses;
+}
+
+/*
+ * Generate the graph (timed as the graph phase), then solve it the way
+ * maxWeightCliquePartitionArenaOrdered does with stats attached
+ */
+static void run_case(const BenchCase* c, BenchResult* r) {
+    memset(r, 0, sizeof(BenchResult));
+    case_name(c, r->name, sizeof(r->name));
+    r->n = c->n;
+    r->k = c->k;
+    r->rss_kb = -1;
+    r->cache_misses = -1;
+
+    Graph g;
+    double start = clock_seconds();
+    if (!generate_graph(&g, c, &r->edges)) return;
+    double generated = clock_seconds();
+
+    PartitionArena arena;
+    maxWeightCliquePartitionStats(&r->stats);
+    int counter = cache_counter_open();
+    int ok = solve_graph_ordered(&g, c->k, c->order, &arena);
+    r->cache_misses = cache_counter_close(counter);
+    maxWeightCliquePartitionStats(NULL);
+    r->wall_ms = (clock_seconds() - generated) * 1e3;
+    r->edge_span = edge_span(&g, c->order);
+    r->stats.phase_ns[MWCP_PHASE_GRAPH] = (long long)((generated - start) * 1e9);
+    for (int p = 0; p < MWCP_PHASE_COUNT; p++) {
+        r->phase_ms[p] = r->stats.phase_ns[p] * 1e-6;
+    }
+    if (ok) {
+        r->cliques = arena.count;
+        r->objective = partition_objective(&g, &arena);
+        r->ok = 1;
+        freePartitionArena(&arena);
+    }
+    graph_free(&g);
+}
+
+static long long peak_rss_kb(void) {
+#ifdef BENCH_FORK
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return -1;
+#ifdef __APPLE__
+    return (long long)ru.ru_maxrss / 1024;
+#else
+    return (long long)ru.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Run one case in a child process so its peak RSS is its own, and so a
+ * crash is reported as a failed case rather than ending the suite
+ */
+static void run_isolated(const BenchCase* c, BenchResult* r) {
+#ifdef BENCH_FORK
+    int fds[2];
+    if (pipe(fds) == 0) {
+        fflush(NULL);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            run_case(c, r);
+            r->rss_kb = peak_rss_kb();
+            ssize_t written = write(fds[1], r, sizeof(BenchResult));
+            _exit(written == (ssize_t)sizeof(BenchResult) ? 0 : 1);
+        }
+        close(fds[1]);
+        int got = 0;
+        if (pid > 0) {
+            got = read(fds[0], r, sizeof(BenchResult)) == (ssize_t)sizeof(BenchResult);
+            waitpid(pid, NULL, 0);
+        }
+        close(fds[0]);
+        if (pid > 0) {
+            if (!got) {
+                memset(r, 0, sizeof(BenchResult));
+                case_name(c, r->name, sizeof(r->name));
+                r->n = c->n;
+                r->k = c->k;
+                r->rss_kb = -1;
+                r->cache_misses = -1;
+            }
+            return;
+        }
+    }
+#endif
+    run_case(c, r);
+    r->rss_kb = peak_rss_kb();
+}
+
+static void write_json(FILE* f, const char* suite, const BenchResult* results, int count) {
+    fprintf(f, "{\n  \"suite\": \"%s\",\n  \"cases\": [\n", suite);
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ok\": %d, \"n\": %d, \"k\": %d, \"edges\": %lld, \"cliques\": %d, "
+                   "\"objective\": %.6f, \"wall_ms\": %.3f, \"rss_kb\": %lld, \"edge_span\": %.1f, \"cache_misses\": %lld",
+                r->name, r->ok, r->n, r->k, r->edges, r->cliques, r->objective, r->wall_ms, r->rss_kb,
+                r->edge_span, r->cache_misses);
+        for (int p = 0; p < MWCP_PHASE_COUNT; p++) {
+            fprintf(f, ", \"%s_ms\": %.3f", maxWeightCliquePartitionPhaseName(p), r->phase_ms[p]);
+        }
+        fprintf(f, ", \"adjacency_probes\": %lld, \"gain_evaluations\": %lld, \"merges_attempted\": %lld, "
+                   "\"merges_accepted\": %lld, \"allocations\": %lld}%s\n",
+                r->stats.adjacency_probes, r->stats.gain_evaluations, r->stats.merges_attempted,
+                r->stats.merges_accepted, r->stats.allocations, i + 1 < count ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void write_csv(FILE* f, const BenchResult* results, int count) {
+    fprintf(f, "name,ok,n,k,edges,cliques,objective,wall_ms,rss_kb,edge_span,cache_misses");
+    for (int p = 0; p < MWCP_PHASE_COUNT; p++) {
+        fprintf(f, ",%s_ms", maxWeightCliquePartitionPhaseName(p));
+    }
+    fprintf(f, ",adjacency_probes,gain_evaluations,merges_attempted,merges_accepted,allocations\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult* r = &results[i];
+        fprintf(f, "%s,%d,%d,%d,%lld,%d,%.6f,%.3f,%lld,%.1f,%lld",
+                r->name, r->ok, r->n, r->k, r->edges, r->cliques, r->objective, r->wall_ms, r->rss_kb,
+                r->edge_span, r->cache_misses);
+        for (int p = 0; p < MWCP_PHASE_COUNT; p++) {
+            fprintf(f, ",%.3f", r->phase_ms[p]);
+        }
+        fprintf(f, ",%lld,%lld,%lld,%lld,%lld\n", r->stats.adjacency_probes, r->stats.gain_evaluations,
+                r->stats.merges_attempted, r->stats.merges_accepted, r->stats.allocations);
+    }
+}
+
+static void print_row(const BenchResult* r) {
+    printf("%-40s %9lld %12.4f %10.1f %9lld %8.0f", r->name, r->edges, r->objective, r->wall_ms, r->rss_kb / 1024,
+           r->edge_span);
+    if (r->cache_misses >= 0) {
+        printf(" %9.2f", r->cache_misses * 1e-6);
+    } else {
+        printf(" %9s", "-");
+    }
+    for (int p = 1; p < MWCP_PHASE_COUNT; p++) {
+        printf(" %8.1f", r->phase_ms[p]);
+    }
+    printf("%s\n", r->ok ? "" : "  FAILED");
+}
+
+/*
+ * Result files written by either writer: JSON is one case per line, CSV
+ * columns are found by header name
+ */
+static int json_number(const char* line, const char* key, double* out) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+    const char* p = strstr(line, pattern);
+    if (!p) return 0;
+    *out = strtod(p + strlen(pattern), NULL);
+    return 1;
+}
+
+static void set_field(BenchResult* r, const char* key, double v) {
+    if (!strcmp(key, "ok")) r->ok = (int)v;
+    else if (!strcmp(key, "n")) r->n = (int)v;
+    else if (!strcmp(key, "k")) r->k = (int)v;
+    else if (!strcmp(key, "edges")) r->edges = (long long)v;
+    else if (!strcmp(key, "cliques")) r->cliques = (int)v;
+    else if (!strcmp(key, "objective")) r->objective = v;
+    else if (!strcmp(key, "wall_ms")) r->wall_ms = v;
+    else if (!strcmp(key, "rss_kb")) r->rss_kb = (long long)v;
+}
+
+static int parse_json_line(const char* line, BenchResult* r) {
+    static const char* keys[] = { "ok", "n", "k", "edges", "cliques", "objective", "wall_ms", "rss_kb" };
+    const char* name = strstr(line, "\"name\": \"");
+    if (!name) return 0;
+    name += 9;
+    size_t len = strcspn(name, "\"");
+    if (len >= sizeof(r->name)) len = sizeof(r->name) - 1;
+    memcpy(r->name, name, len);
+    for (int i = 0; i < 8; i++) {
+        double v;
+        if (json_number(line, keys[i], &v)) set_field(r, keys[i], v);
+    }
+    return 1;
+}
+
+static int parse_csv_line(char* line, char* header, BenchResult* r) {
+    char* h = header;
+    char* v = line;
+    for (int col = 0; h && v; col++) {
+        char* h_end = strpbrk(h, ",\r\n");
+        char* v_end = strpbrk(v, ",\r\n");
+        if (h_end) *h_end = '\0';
+        if (v_end) *v_end = '\0';
+        if (col == 0) {
+            size_t len = strlen(v) < sizeof(r->name) ? strlen(v) : sizeof(r->name) - 1;
+            memcpy(r->name, v, len);
+        } else {
+            set_field(r, h, strtod(v, NULL));
+        }
+        h = h_end ? h_end + 1 : NULL;
+        v = v_end ? v_end + 1 : NULL;
+    }
+    return r->name[0] != '\0';
+}
+
+static BenchResult* load_results(const char* path, int* count) {
+    FILE* f = fopen(path, "r");
+    if (!f) return NULL;
+    int cap = 64;
+    BenchResult* results = (BenchResult*)calloc((size_t)cap, sizeof(BenchResult));
+    char line[4096];
+    char header[4096] = "";
+    char columns[4096];
+    *count = 0;
+    while (results && fgets(line, sizeof(line), f)) {
+        BenchResult r;
+        memset(&r, 0, sizeof(r));
+        r.rss_kb = -1;
+        r.cache_misses = -1;
+        if (!header[0] && !strncmp(line, "name,", 5)) {
+            strcpy(header, line);
+            continue;
+        }
+        // parse_csv_line splits the header in place, so hand it a copy
+        strcpy(columns, header);
+        if (!(header[0] ? parse_csv_line(line, columns, &r) : parse_json_line(line, &r))) continue;
+        if (*count == cap) {
+            cap *= 2;
+            BenchResult* grown = (BenchResult*)realloc(results, (size_t)cap * sizeof(BenchResult));
+            if (!grown) {
+                free(results);
+                results = NULL;
+                break;
+            }
+            results = grown;
+        }
+        results[(*count)++] = r;
+    }
+    fclose(f);
+    return results;
+}
+
+/*
+ * Case-by-case comparison. A case regresses when it fails, loses objective,
+ * or gets slower or larger by more than the tolerance; timings under 5 ms
+ * are too noisy to judge. Returns the number of regressions.
+ */
+static int compare_runs(const char* old_path, const char* new_path, double tolerance) {
+    int old_count, new_count;
+    BenchResult* old_results = load_results(old_path, &old_count);
+    BenchResult* new_results = load_results(new_path, &new_count);
+    if (!old_results || !new_results) {
+        fprintf(stderr, "cannot read %s\n", old_results ? new_path : old_path);
+        free(old_results);
+        free(new_results);
+        return -1;
+    }
+
+    int regressions = 0;
+    printf("%-40s %10s %10s %8s %12s %12s %8s\n", "case", "old ms", "new ms", "time", "old obj", "new obj", "rss");
+    for (int i = 0; i < new_count; i++) {
+        const BenchResult* b = &new_results[i];
+        const BenchResult* a = NULL;
+        for (int j = 0; j < old_count && !a; j++) {
+            if (!strcmp(old_results[j].name, b->name)) a = &old_results[j];
+        }
+        if (!a) {
+            printf("%-40s %10s %10.1f %8s %12s %12.4f %8s  new\n", b->name, "-", b->wall_ms, "-", "-", b->objective, "-");
+            continue;
+        }
+        double time_ratio = a->wall_ms > 0 ? b->wall_ms / a->wall_ms : 1.0;
+        double rss_ratio = a->rss_kb > 0 && b->rss_kb > 0 ? (double)b->rss_kb / a->rss_kb : 1.0;
+        int slower = time_ratio > 1.0 + tolerance && b->wall_ms - a->wall_ms > 5.0;
+        int worse = b->objective < a->objective - 1e-9 * (1.0 + (a->objective < 0 ? -a->objective : a->objective));
+        int larger = rss_ratio > 1.0 + tolerance;
+        int failed = a->ok && !b->ok;
+        printf("%-40s %10.1f %10.1f %7.2fx %12.4f %12.4f %7.2fx%s%s%s%s\n", b->name, a->wall_ms, b->wall_ms, time_ratio,
+               a->objective, b->objective, rss_ratio, failed ? "  FAILED" : "", slower ? "  SLOWER" : "",
+               worse ? "  WORSE" : "", larger ? "  LARGER" : "");
+        if (failed || slower || worse || larger) regressions++;
+    }
+    printf("%d regression(s)\n", regressions);
+    free(old_results);
+    free(new_results);
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    const char* suite = "quick";
+    const char* filter = NULL;
+    const char* json_path = NULL;
+    const char* csv_path = NULL;
+    const char* compare_old = NULL;
+    const char* compare_new = NULL;
+    double tolerance = 0.10;
+    int repeat = 1;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--suite") && i + 1 < argc) suite = argv[++i];
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+        else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && i + 1 < argc) json_path = argv[++i];
+        else if (!strcmp(argv[i], "--csv") && i + 1 < argc) csv_path = argv[++i];
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc) tolerance = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--compare") && i + 2 < argc) {
+            compare_old = argv[++i];
+            compare_new = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--suite quick|full] [--filter TEXT] [--repeat N] [--json FILE] [--csv FILE]\n"
+                            "       %s --compare OLD NEW [--tolerance FRACTION]\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (compare_old) {
+        return compare_runs(compare_old, compare_new, tolerance) == 0 ? 0 : 1;
+    }
+    int full = !strcmp(suite, "full");
+    if (repeat < 1) repeat = 1;
+
+    int total = (int)(sizeof(cases) / sizeof(cases[0]));
+    BenchResult* results = (BenchResult*)calloc((size_t)total, sizeof(BenchResult));
+    if (!results) return 1;
+    int count = 0;
+    int failures = 0;
+    printf("%-40s %9s %12s %10s %9s %8s %9s", "case", "edges", "objective", "wall ms", "rss MB", "span", "misses M");
+    for (int p = 1; p < MWCP_PHASE_COUNT; p++) {
+        const char* name = maxWeightCliquePartitionPhaseName(p);
+        printf(" %8.8s", name);
+    }
+    printf("\n");
+    for (int i = 0; i < total; i++) {
+        const BenchCase* c = &cases[i];
+        char name[64];
+        case_name(c, name, sizeof(name));
+        if ((c->full_only && !full) || (filter && !strstr(name, filter))) continue;
+
+        // Fastest of the repeats; the solver is deterministic, so the objective is the same
+        BenchResult* best = &results[count++];
+        long long rss = -1;
+        for (int rep = 0; rep < repeat; rep++) {
+            BenchResult r;
+            run_isolated(c, &r);
+            if (r.rss_kb > rss) rss = r.rss_kb;
+            if (rep == 0 || (r.ok && (!best->ok || r.wall_ms < best->wall_ms))) *best = r;
+        }
+        best->rss_kb = rss;
+        if (!best->ok) failures++;
+        print_row(best);
+        fflush(stdout);
+    }
+
+    FILE* f;
+    if (json_path && (f = fopen(json_path, "w")) != NULL) {
+        write_json(f, suite, results, count);
+        fclose(f);
+    }
+    if (csv_path && (f = fopen(csv_path, "w")) != NULL) {
+        write_csv(f, results, count);
+        fclose(f);
+    }
+    free(results);
+    return failures ? 1 : 0;
+}
@@ -1,6 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+#ifdef MWCP_USE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MWCP_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #define NO_EDGE -9999
 #define MIN_WEIGHT -1000000
@@ -10,6 +27,109 @@ typedef struct {
     int weight;
 } Edge;
 
+/*
+ * Optional instrumentation, built in with -DMWCP_STATS. A caller attaches
+ * an MwcpStats to its thread with maxWeightCliquePartitionStats; solves on
+ * that thread then add exclusive wall time per phase (nanoseconds) and event
+ * counters to it. Without MWCP_STATS every hook expands to nothing and
+ * attaching has no effect. Helper threads (parallel loading, multi-start
+ * and exact workers) count towards the phase that spawned them, but their
+ * events are not counted.
+ */
+#define MWCP_PHASE_GRAPH 0          // building or loading the graph
+#define MWCP_PHASE_COLLECT 1        // edge collection
+#define MWCP_PHASE_SORT 2           // edge ordering, lazy buckets included
+#define MWCP_PHASE_CANDIDATES 3     // candidate clique enumeration
+#define MWCP_PHASE_SEED 4           // Phase 1: seeding and expansion
+#define MWCP_PHASE_ASSIGN 5         // Phase 2
+#define MWCP_PHASE_MERGE 6          // Phase 3
+#define MWCP_PHASE_LOCAL_SEARCH 7   // Phase 4
+#define MWCP_PHASE_EXPORT 8         // building the output partition
+#define MWCP_PHASE_REDUCE 9         // singleton fixing and component split
+#define MWCP_PHASE_REORDER 10       // node relabeling for locality
+#define MWCP_PHASE_COUNT 11
+
+typedef struct {
+    long long phase_ns[MWCP_PHASE_COUNT];
+    long long edges_collected;
+    long long adjacency_probes;
+    long long gain_evaluations;     // node-to-clique gain table lookups
+    long long merges_attempted;     // merge candidates popped, stale ones included
+    long long merges_accepted;
+    long long allocations;          // the solver's own malloc, calloc and realloc calls
+} MwcpStats;
+
+#ifdef MWCP_STATS
+#define STATS_MAX_DEPTH 8
+
+typedef struct {
+    MwcpStats* sink;
+    int phase[STATS_MAX_DEPTH];     // open phases, innermost last
+    int depth;
+    long long mark;                 // when time was last charged
+} StatsState;
+
+static __thread StatsState stats_state;
+
+static long long stats_now_ns(void) {
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#else
+    return (long long)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+
+// Charge the time since the last mark to the innermost open phase
+static void stats_charge(void) {
+    long long now = stats_now_ns();
+    int top = stats_state.depth < STATS_MAX_DEPTH ? stats_state.depth : STATS_MAX_DEPTH;
+    if (top > 0) stats_state.sink->phase_ns[stats_state.phase[top - 1]] += now - stats_state.mark;
+    stats_state.mark = now;
+}
+
+static void stats_enter(int phase) {
+    if (!stats_state.sink) return;
+    stats_charge();
+    if (stats_state.depth < STATS_MAX_DEPTH) stats_state.phase[stats_state.depth] = phase;
+    stats_state.depth++;
+}
+
+static void stats_leave(void) {
+    if (!stats_state.sink || stats_state.depth == 0) return;
+    stats_charge();
+    stats_state.depth--;
+}
+
+#define STAT_ENTER(phase) stats_enter(phase)
+#define STAT_LEAVE() stats_leave()
+#define STAT_ADD(field, amount) do { if (stats_state.sink) stats_state.sink->field += (amount); } while (0)
+#else
+#define STAT_ENTER(phase) ((void)0)
+#define STAT_LEAVE() ((void)0)
+#define STAT_ADD(field, amount) ((void)0)
+#endif
+
+/*
+ * The solver allocates through these, so MWCP_STATS counts its own
+ * allocations and nothing of the caller's
+ */
+static inline void* mwcp_malloc(size_t size) {
+    STAT_ADD(allocations, 1);
+    return malloc(size);
+}
+
+static inline void* mwcp_calloc(size_t count, size_t size) {
+    STAT_ADD(allocations, 1);
+    return calloc(count, size);
+}
+
+static inline void* mwcp_realloc(void* ptr, size_t size) {
+    STAT_ADD(allocations, 1);
+    return realloc(ptr, size);
+}
+
 /*
  * Safe access to upper-triangular matrix
  */
@@ -63,256 +183,5525 @@ int can_add_to_clique(int** weights, int n, int* clique, int size, int node) {
 }
 
 /*
- * Compare function for sorting edges by weight (descending)
+ * Bit-packed adjacency matrix: one row of n bits per node, 64 nodes per word.
+ * Row u has bit v set iff u and v are connected (the diagonal is left clear).
  */
-int compare_edges(const void* a, const void* b) {
-    if (a == NULL || b == NULL) return 0;
-    Edge* ea = (Edge*)a;
-    Edge* eb = (Edge*)b;
-    if (eb->weight > ea->weight) return 1;
-    if (eb->weight < ea->weight) return -1;
-    return 0;
+typedef struct {
+    int n;
+    int words;          // 64-bit words per row
+    uint64_t* bits;     // n * words
+} AdjacencyBits;
+
+static inline const uint64_t* adjacency_row(const AdjacencyBits* adj, int u) {
+    return adj->bits + (size_t)u * adj->words;
+}
+
+static inline int adjacency_test(const AdjacencyBits* adj, int u, int v) {
+    STAT_ADD(adjacency_probes, 1);
+    return (int)((adjacency_row(adj, u)[v >> 6] >> (v & 63)) & 1);
+}
+
+static void adjacency_free(AdjacencyBits* adj) {
+    free(adj->bits);
+    adj->bits = NULL;
 }
 
 /*
- * Main clique partition function
+ * Read-only view of a whole file: memory-mapped where possible, otherwise
+ * read into one heap buffer. An empty file maps to a zero-length view.
  */
-int** maxWeightCliquePartition(int** weights, int n, int k, int* partition_size, int** clique_sizes) {
-    // Input validation
-    if (n <= 0 || n > 10000 || k <= 0 || k > n) return NULL;
-    if (partition_size == NULL || clique_sizes == NULL) return NULL;
-    
-    // Initialize output
-    *partition_size = 0;
-    *clique_sizes = NULL;
-    
-    // Allocate for worst case (each node in its own clique)
-    int** partition = (int**)calloc(n, sizeof(int*));
-    if (!partition) return NULL;
-    
-    *clique_sizes = (int*)calloc(n, sizeof(int));
-    if (!*clique_sizes) {
-        free(partition);
-        return NULL;
+typedef struct {
+    const char* data;
+    size_t size;
+    void* map;              // mmap base, NULL when data lives in heap
+    char* heap;
+} MappedFile;
+
+static void mapped_file_close(MappedFile* mf) {
+#ifdef MWCP_HAVE_MMAP
+    if (mf->map) munmap(mf->map, mf->size);
+#endif
+    free(mf->heap);
+    memset(mf, 0, sizeof(MappedFile));
+}
+
+static int mapped_file_open(MappedFile* mf, const char* path) {
+    memset(mf, 0, sizeof(MappedFile));
+    mf->data = "";
+#ifdef MWCP_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            close(fd);
+            return 1;
+        }
+        void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map != MAP_FAILED) {
+            mf->map = map;
+            mf->data = (const char*)map;
+            mf->size = (size_t)st.st_size;
+            close(fd);
+            return 1;
+        }
     }
-    
-    int* node_assigned = (int*)calloc(n, sizeof(int));
-    if (!node_assigned) {
-        free(partition);
-        free(*clique_sizes);
-        *clique_sizes = NULL;
-        return NULL;
+    close(fd);
+#endif
+    // Fallback: read the whole stream into one growing buffer
+    FILE* f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t cap = 1 << 20;
+    mf->heap = (char*)mwcp_malloc(cap);
+    while (mf->heap) {
+        mf->size += fread(mf->heap + mf->size, 1, cap - mf->size, f);
+        if (mf->size < cap) break;
+        char* grown = (char*)mwcp_realloc(mf->heap, cap * 2);
+        if (!grown) {
+            free(mf->heap);
+            mf->heap = NULL;
+            break;
+        }
+        mf->heap = grown;
+        cap *= 2;
+    }
+    int ok = mf->heap != NULL && !ferror(f);
+    fclose(f);
+    if (!ok) {
+        mapped_file_close(mf);
+        return 0;
+    }
+    mf->data = mf->heap;
+    return 1;
+}
+
+/*
+ * Internal graph: the upper-triangular input copied once into a single
+ * contiguous, cache-line aligned buffer, plus the adjacency bitset (dense
+ * and packed layouts). A graph loaded from a .mwcp file may instead point
+ * both into the mapped file.
+ *
+ * GRAPH_DENSE stores a symmetric n x stride matrix (rows padded to a cache
+ * line, diagonal 0). GRAPH_PACKED stores only the strict upper triangle and
+ * is used once the dense copy would exceed GRAPH_DENSE_MAX_BYTES.
+ * GRAPH_SPARSE stores sorted neighbour lists with their weights (CSR, both
+ * directions) and is chosen whenever the measured edge density is at most
+ * GRAPH_SPARSE_MAX_DENSITY, so per-node work is O(degree) instead of O(n).
+ * It has no bitset: memory is O(n + m), and adjacency is answered from the
+ * sorted rows.
+ */
+#define GRAPH_DENSE 0
+#define GRAPH_PACKED 1
+#define GRAPH_SPARSE 2
+#define GRAPH_ALIGNMENT 64
+#ifndef GRAPH_DENSE_MAX_BYTES
+#define GRAPH_DENSE_MAX_BYTES (256LL * 1024 * 1024)
+#endif
+#ifndef GRAPH_SPARSE_MAX_DENSITY
+#define GRAPH_SPARSE_MAX_DENSITY 0.05
+#endif
+
+typedef struct {
+    int n;
+    int layout;
+    size_t stride;          // dense: ints per row; packed: unused
+    size_t* row_offset;     // packed: index of (u, v) is row_offset[u] + v
+    int* w;                 // aligned weight storage
+    void* w_block;          // underlying allocation of w
+    size_t* nbr_start;      // sparse: neighbours of u are nbr[nbr_start[u] .. nbr_start[u + 1])
+    int* nbr;               // sparse: neighbour ids, ascending per row
+    int* nbr_w;             // sparse: matching edge weights
+    AdjacencyBits adj;      // dense/packed only; sparse graphs search their rows
+    MappedFile file;        // backing store of w and adj.bits when loaded in place
+} Graph;
+
+/*
+ * Index of v in u's CSR row, or the end of the row when they are not adjacent
+ */
+static inline size_t graph_sparse_slot(const Graph* g, int u, int v) {
+    size_t lo = g->nbr_start[u], end = g->nbr_start[u + 1], hi = end;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (g->nbr[mid] < v) lo = mid + 1; else hi = mid;
+    }
+    return lo < end && g->nbr[lo] == v ? lo : end;
+}
+
+static inline int graph_sparse_weight(const Graph* g, int u, int v) {
+    size_t e = graph_sparse_slot(g, u, v);
+    return e < g->nbr_start[u + 1] ? g->nbr_w[e] : NO_EDGE;
+}
+
+/*
+ * Unchecked weight lookup for hot paths: requires 0 <= u, v < n and u != v.
+ * Sparse graphs binary-search u's row; loops over a node's neighbours should
+ * use NeighbourIter instead.
+ */
+static inline int graph_weight(const Graph* g, int u, int v) {
+    if (g->layout == GRAPH_DENSE) {
+        return g->w[(size_t)u * g->stride + v];
+    }
+    if (g->layout == GRAPH_SPARSE) return graph_sparse_weight(g, u, v);
+    int lo = u < v ? u : v;
+    int hi = u ^ v ^ lo;
+    return g->w[g->row_offset[lo] + hi];
+}
+
+/*
+ * Whether u and v (u != v) are connected: a bit test on the dense and packed
+ * layouts, a binary search of the shorter CSR row on the sparse one
+ */
+static inline int graph_adjacent(const Graph* g, int u, int v) {
+    if (g->layout != GRAPH_SPARSE) return adjacency_test(&g->adj, u, v);
+    STAT_ADD(adjacency_probes, 1);
+    if (g->nbr_start[v + 1] - g->nbr_start[v] < g->nbr_start[u + 1] - g->nbr_start[u]) {
+        int t = u;
+        u = v;
+        v = t;
+    }
+    return graph_sparse_slot(g, u, v) < g->nbr_start[u + 1];
+}
+
+/*
+ * Pointer to the contiguous weights from u to every node (dense layout only)
+ */
+static inline const int* graph_row(const Graph* g, int u) {
+    return g->w + (size_t)u * g->stride;
+}
+
+/*
+ * Grow-only buffer: buf is returned as is when it already holds `bytes`,
+ * otherwise it is released for a larger one (contents are not kept). *cap
+ * tracks its size; on failure NULL is returned and *cap is 0.
+ */
+static void* buffer_reserve(void* buf, size_t* cap, size_t bytes) {
+    if (buf && *cap >= bytes) return buf;
+    free(buf);
+    buf = mwcp_malloc(bytes > 0 ? bytes : 1);
+    *cap = buf ? bytes : 0;
+    return buf;
+}
+
+/*
+ * Buffers a graph borrows when it is rebuilt for one input after another,
+ * each grown only past the largest input so far. A graph built from a
+ * store must not be passed to graph_free; graph_store_free releases them.
+ */
+#define GRAPH_STORE_W 0             // weights, aligned inside the block
+#define GRAPH_STORE_ADJ 1
+#define GRAPH_STORE_OFFSETS 2       // packed row offsets or sparse row starts
+#define GRAPH_STORE_NBR 3
+#define GRAPH_STORE_NBR_W 4
+#define GRAPH_STORE_DEGREE 5        // graph_build's counting pass
+#define GRAPH_STORE_BUFFERS 6
+
+typedef struct {
+    void* buf[GRAPH_STORE_BUFFERS];
+    size_t bytes[GRAPH_STORE_BUFFERS];
+} GraphStore;
+
+static void graph_store_free(GraphStore* store) {
+    for (int i = 0; i < GRAPH_STORE_BUFFERS; i++) {
+        free(store->buf[i]);
+    }
+    memset(store, 0, sizeof(GraphStore));
+}
+
+/*
+ * One graph buffer: a fresh allocation without a store, else the store's
+ * buffer for `slot`. With `zero` set it is cleared.
+ */
+static void* graph_take(GraphStore* store, int slot, size_t bytes, int zero) {
+    if (!store) return zero ? mwcp_calloc(bytes > 0 ? bytes : 1, 1) : mwcp_malloc(bytes > 0 ? bytes : 1);
+    void* p = buffer_reserve(store->buf[slot], &store->bytes[slot], bytes);
+    store->buf[slot] = p;
+    if (p && zero) memset(p, 0, bytes);
+    return p;
+}
+
+static void* aligned_calloc(GraphStore* store, size_t count, size_t size, void** block) {
+    *block = graph_take(store, GRAPH_STORE_W, count * size + GRAPH_ALIGNMENT, 1);
+    if (!*block) return NULL;
+    uintptr_t p = ((uintptr_t)*block + GRAPH_ALIGNMENT - 1) & ~(uintptr_t)(GRAPH_ALIGNMENT - 1);
+    if (store) *block = NULL;
+    return (void*)p;
+}
+
+static void graph_free(Graph* g) {
+    if (g->file.data) {
+        // w and adj.bits point into the file
+        mapped_file_close(&g->file);
+        g->adj.bits = NULL;
+    }
+    free(g->w_block);
+    free(g->row_offset);
+    free(g->nbr_start);
+    free(g->nbr);
+    free(g->nbr_w);
+    adjacency_free(&g->adj);
+    g->w = NULL;
+    g->w_block = NULL;
+    g->row_offset = NULL;
+    g->nbr_start = NULL;
+    g->nbr = NULL;
+    g->nbr_w = NULL;
+}
+
+/*
+ * Ascending walk over the neighbours of u that are >= from, with weights:
+ * the CSR row for sparse graphs, the adjacency bitset otherwise
+ */
+typedef struct {
+    const Graph* g;
+    int u;
+    size_t e, end;          // sparse: remaining slice of u's row
+    const uint64_t* row;    // dense/packed: adjacency row of u
+    int word_index;
+    uint64_t word;
+} NeighbourIter;
+
+static inline void neighbour_iter_init(NeighbourIter* it, const Graph* g, int u, int from) {
+    memset(it, 0, sizeof(NeighbourIter));
+    it->g = g;
+    it->u = u;
+    if (g->layout == GRAPH_SPARSE) {
+        size_t lo = g->nbr_start[u], hi = g->nbr_start[u + 1];
+        it->end = hi;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (g->nbr[mid] < from) lo = mid + 1; else hi = mid;
+        }
+        it->e = lo;
+        return;
+    }
+    it->row = adjacency_row(&g->adj, u);
+    it->word_index = from >> 6;
+    it->word = from < g->n ? it->row[it->word_index] & (~0ULL << (from & 63)) : 0;
+}
+
+static inline int neighbour_iter_next(NeighbourIter* it, int* v, int* w) {
+    const Graph* g = it->g;
+    if (g->layout == GRAPH_SPARSE) {
+        if (it->e == it->end) return 0;
+        *v = g->nbr[it->e];
+        *w = g->nbr_w[it->e++];
+        return 1;
+    }
+    while (!it->word) {
+        if (++it->word_index >= g->adj.words) return 0;
+        it->word = it->row[it->word_index];
+    }
+    *v = (it->word_index << 6) + __builtin_ctzll(it->word);
+    it->word &= it->word - 1;
+    *w = graph_weight(g, it->u, *v);
+    return 1;
+}
+
+static inline int graph_degree(const Graph* g, int u) {
+    if (g->layout == GRAPH_SPARSE) return (int)(g->nbr_start[u + 1] - g->nbr_start[u]);
+    int degree = 0;
+    const uint64_t* row = adjacency_row(&g->adj, u);
+    for (int i = 0; i < g->adj.words; i++) {
+        degree += __builtin_popcountll(row[i]);
     }
+    return degree;
+}
+
+/*
+ * Allocate an n-node graph with every pair reading as 0 and no adjacency
+ * bits set, from `store` if it is not NULL. Rows are then filled through
+ * graph_upper_row and graph_finish_row.
+ */
+static int graph_alloc_from(Graph* g, int n, GraphStore* store) {
+    memset(g, 0, sizeof(Graph));
+    g->n = n;
+    g->adj.n = n;
+    g->adj.words = (n + 63) / 64;
+    g->adj.bits = (uint64_t*)graph_take(store, GRAPH_STORE_ADJ, (size_t)n * g->adj.words * sizeof(uint64_t), 1);
+    if (!g->adj.bits) return 0;
     
-    // Handle single node case
-    if (n == 1) {
-        partition[0] = (int*)calloc(1, sizeof(int));
-        if (partition[0]) {
-            partition[0][0] = 0;
-            (*clique_sizes)[0] = 1;
-            *partition_size = 1;
-        }
-        free(node_assigned);
-        return partition;
-    }
-    
-    // Count and collect edges
-    long long edge_capacity = ((long long)n * (n - 1)) / 2;
-    if (edge_capacity > 1000000) edge_capacity = 1000000; // Limit edge count
-    
-    Edge* edges = (Edge*)malloc(edge_capacity * sizeof(Edge));
-    if (!edges) {
-        // Continue without edge optimization
-        for (int i = 0; i < n; i++) {
-            partition[i] = (int*)calloc(1, sizeof(int));
-            if (partition[i]) {
-                partition[i][0] = i;
-                (*clique_sizes)[i] = 1;
-                (*partition_size)++;
-            }
-        }
-        free(node_assigned);
-        return partition;
-    }
-    
-    int edge_count = 0;
-    if (weights != NULL) {
-        for (int i = 0; i < n - 1 && i < 1000; i++) { // Limit iterations
-            if (weights[i] == NULL) continue;
-            for (int j = 0; j < n - 1 - i && j < 1000; j++) { // Limit iterations
-                int v = i + j + 1;
-                if (v >= n) break;
-                
-                int w = weights[i][j];
-                if (w != NO_EDGE && w > MIN_WEIGHT && w < -MIN_WEIGHT) {
-                    if (edge_count < edge_capacity) {
-                        edges[edge_count].u = i;
-                        edges[edge_count].v = v;
-                        edges[edge_count].weight = w;
-                        edge_count++;
-                    }
-                }
+    size_t padded = ((size_t)n + 15) & ~(size_t)15;
+    if ((long long)n * (long long)padded * (long long)sizeof(int) <= GRAPH_DENSE_MAX_BYTES) {
+        g->layout = GRAPH_DENSE;
+        g->stride = padded;
+        g->w = (int*)aligned_calloc(store, (size_t)n * padded, sizeof(int), &g->w_block);
+    } else {
+        g->layout = GRAPH_PACKED;
+        g->row_offset = (size_t*)graph_take(store, GRAPH_STORE_OFFSETS, (size_t)n * sizeof(size_t), 0);
+        if (g->row_offset) {
+            g->w = (int*)aligned_calloc(store, (size_t)n * (n - 1) / 2 + 1, sizeof(int), &g->w_block);
+            size_t start = 0;
+            for (int u = 0; u < n; u++) {
+                // row_offset[u] + v lands on column v - u - 1 of row u
+                g->row_offset[u] = start - (size_t)u - 1;
+                start += (size_t)(n - 1 - u);
             }
         }
     }
-    
-    // Sort edges by weight (descending) if there are edges
-    if (edge_count > 0) {
-        qsort(edges, edge_count, sizeof(Edge), compare_edges);
+    if (!g->w) {
+        if (!store) graph_free(g);
+        return 0;
     }
-    
-    // Build initial cliques from high-weight edges
-    for (int e = 0; e < edge_count && *partition_size < n; e++) {
-        int u = edges[e].u;
-        int v = edges[e].v;
-        
-        if (u < 0 || u >= n || v < 0 || v >= n) continue;
-        if (node_assigned[u] || node_assigned[v]) continue;
-        
-        // Allocate new clique
-        partition[*partition_size] = (int*)calloc(k, sizeof(int));
-        if (!partition[*partition_size]) continue;
-        
-        partition[*partition_size][0] = u;
-        partition[*partition_size][1] = v;
-        (*clique_sizes)[*partition_size] = 2;
-        node_assigned[u] = 1;
-        node_assigned[v] = 1;
-        
-        // Try to expand clique
-        for (int node = 0; node < n && (*clique_sizes)[*partition_size] < k; node++) {
-            if (!node_assigned[node] && 
-                can_add_to_clique(weights, n, partition[*partition_size], 
-                                (*clique_sizes)[*partition_size], node)) {
-                
-                // Calculate weight gain
-                long long gain = 0;
-                for (int i = 0; i < (*clique_sizes)[*partition_size]; i++) {
-                    int w = safe_get_weight(weights, n, partition[*partition_size][i], node);
-                    if (w != NO_EDGE && w > MIN_WEIGHT && w < -MIN_WEIGHT) {
-                        gain += w;
-                    }
-                }
-                
-                if (gain > 0) {
-                    partition[*partition_size][(*clique_sizes)[*partition_size]] = node;
-                    (*clique_sizes)[*partition_size]++;
-                    node_assigned[node] = 1;
-                }
+    return 1;
+}
+
+static int graph_alloc(Graph* g, int n) {
+    return graph_alloc_from(g, n, NULL);
+}
+
+/*
+ * Writable storage for the n - 1 - u weights from u to nodes u + 1 .. n - 1
+ */
+static inline int* graph_upper_row(Graph* g, int u) {
+    if (g->layout == GRAPH_DENSE) {
+        return g->w + (size_t)u * g->stride + u + 1;
+    }
+    return g->w + g->row_offset[u] + u + 1;
+}
+
+/*
+ * Mirror row u into the lower half (dense layout) and set the adjacency bits
+ * of its edges. With `shared` set, bits in other nodes' rows are set
+ * atomically so different rows can be finished concurrently.
+ */
+static void graph_finish_row(Graph* g, int u, int shared) {
+    const int* src = graph_upper_row(g, u);
+    uint64_t* row_u = g->adj.bits + (size_t)u * g->adj.words;
+    uint64_t bit_u = 1ULL << (u & 63);
+    for (int v = u + 1; v < g->n; v++) {
+        int w = src[v - u - 1];
+        if (g->layout == GRAPH_DENSE) {
+            g->w[(size_t)v * g->stride + u] = w;
+        }
+        if (w == NO_EDGE) continue;
+        uint64_t* word = g->adj.bits + (size_t)v * g->adj.words + (u >> 6);
+        if (shared) {
+            __atomic_fetch_or(&row_u[v >> 6], 1ULL << (v & 63), __ATOMIC_RELAXED);
+            __atomic_fetch_or(word, bit_u, __ATOMIC_RELAXED);
+        } else {
+            row_u[v >> 6] |= 1ULL << (v & 63);
+            *word |= bit_u;
+        }
+    }
+}
+
+static inline int graph_is_sparse(int n, long long edges) {
+    return n > 1 && (double)edges <= GRAPH_SPARSE_MAX_DENSITY * ((double)n * (n - 1) / 2.0);
+}
+
+/*
+ * Allocate a sparse graph for the given degrees, from `store` if it is not
+ * NULL. On return degree[u] holds the fill cursor of row u for
+ * graph_sparse_append.
+ */
+static int graph_alloc_sparse_from(Graph* g, int n, size_t* degree, GraphStore* store) {
+    memset(g, 0, sizeof(Graph));
+    g->n = n;
+    g->layout = GRAPH_SPARSE;
+    g->adj.n = n;
+    g->nbr_start = (size_t*)graph_take(store, GRAPH_STORE_OFFSETS, ((size_t)n + 1) * sizeof(size_t), 0);
+    if (!g->nbr_start) {
+        if (!store) graph_free(g);
+        return 0;
+    }
+    size_t total = 0;
+    for (int u = 0; u < n; u++) {
+        g->nbr_start[u] = total;
+        total += degree[u];
+        degree[u] = g->nbr_start[u];
+    }
+    g->nbr_start[n] = total;
+    g->nbr = (int*)graph_take(store, GRAPH_STORE_NBR, total * sizeof(int), 0);
+    g->nbr_w = (int*)graph_take(store, GRAPH_STORE_NBR_W, total * sizeof(int), 0);
+    if (!g->nbr || !g->nbr_w) {
+        if (!store) graph_free(g);
+        return 0;
+    }
+    return 1;
+}
+
+static int graph_alloc_sparse(Graph* g, int n, size_t* degree) {
+    return graph_alloc_sparse_from(g, n, degree, NULL);
+}
+
+/*
+ * Add edge (u, v), u < v, to both rows. Rows stay sorted as long as edges
+ * arrive in ascending (u, v) order.
+ */
+static inline void graph_sparse_append(Graph* g, size_t* fill, int u, int v, int w) {
+    g->nbr[fill[u]] = v;
+    g->nbr_w[fill[u]++] = w;
+    g->nbr[fill[v]] = u;
+    g->nbr_w[fill[v]++] = w;
+}
+
+/*
+ * Copy the upper-triangular input into the internal layout and build the
+ * adjacency bitset. Missing rows read as NO_EDGE; this is the only place the
+ * caller's jagged rows are touched. One counting pass measures the density
+ * and picks the sparse layout when it is low enough. With a store, every
+ * buffer (the counting pass included) comes from it.
+ */
+static int graph_build_from(Graph* g, int** weights, int n, GraphStore* store) {
+    size_t* degree = (size_t*)graph_take(store, GRAPH_STORE_DEGREE, ((size_t)n + 1) * sizeof(size_t), 1);
+    long long edges = 0;
+    for (int u = 0; degree && weights && u < n - 1; u++) {
+        const int* src = weights[u];
+        for (int j = 0; src && j < n - 1 - u; j++) {
+            if (src[j] == NO_EDGE) continue;
+            degree[u]++;
+            degree[u + 1 + j]++;
+            edges++;
+        }
+    }
+    if (degree && graph_is_sparse(n, edges)) {
+        int ok = graph_alloc_sparse_from(g, n, degree, store);
+        for (int u = 0; ok && weights && u < n - 1; u++) {
+            const int* src = weights[u];
+            for (int j = 0; src && j < n - 1 - u; j++) {
+                if (src[j] != NO_EDGE) graph_sparse_append(g, degree, u, u + 1 + j, src[j]);
             }
         }
-        
-        (*partition_size)++;
+        if (!store) free(degree);
+        return ok;
     }
+    if (!store) free(degree);
     
-    // Assign remaining nodes
-    for (int node = 0; node < n; node++) {
-        if (!node_assigned[node]) {
-            int best_clique = -1;
-            long long best_gain = MIN_WEIGHT;
-            
-            // Try existing cliques
-            for (int c = 0; c < *partition_size && c < n; c++) {
-                if ((*clique_sizes)[c] < k && 
-                    can_add_to_clique(weights, n, partition[c], (*clique_sizes)[c], node)) {
-                    
-                    long long gain = 0;
-                    for (int i = 0; i < (*clique_sizes)[c]; i++) {
-                        int w = safe_get_weight(weights, n, partition[c][i], node);
-                        if (w != NO_EDGE && w > MIN_WEIGHT && w < -MIN_WEIGHT) {
-                            gain += w;
-                        }
-                    }
-                    
-                    if (gain > best_gain) {
-                        best_gain = gain;
-                        best_clique = c;
-                    }
+    if (!graph_alloc_from(g, n, store)) return 0;
+    for (int u = 0; u < n; u++) {
+        const int* src = (weights != NULL && u < n - 1) ? weights[u] : NULL;
+        int* dst = graph_upper_row(g, u);
+        int len = n - 1 - u;
+        for (int j = 0; j < len; j++) {
+            dst[j] = src ? src[j] : NO_EDGE;
+        }
+        graph_finish_row(g, u, 0);
+    }
+    return 1;
+}
+
+static int graph_build(Graph* g, int** weights, int n) {
+    return graph_build_from(g, weights, n, NULL);
+}
+
+/*
+ * Switch a dense or packed graph built in place (text or binary input) to
+ * the sparse layout if its measured density is low enough. The graph is
+ * left unchanged if the sparse copy cannot be allocated.
+ */
+static void graph_select_layout(Graph* g) {
+    int n = g->n;
+    if (g->layout == GRAPH_SPARSE || g->file.data) return;
+    size_t* degree = (size_t*)mwcp_malloc(((size_t)n + 1) * sizeof(size_t));
+    if (!degree) return;
+    long long edges = 0;
+    for (int u = 0; u < n; u++) {
+        degree[u] = (size_t)graph_degree(g, u);
+        edges += (long long)degree[u];
+    }
+    Graph sparse;
+    if (graph_is_sparse(n, edges / 2) && graph_alloc_sparse(&sparse, n, degree)) {
+        for (int u = 0; u < n; u++) {
+            NeighbourIter it;
+            int v, w;
+            neighbour_iter_init(&it, g, u, u + 1);
+            while (neighbour_iter_next(&it, &v, &w)) {
+                graph_sparse_append(&sparse, degree, u, v, w);
+            }
+        }
+        graph_free(g);
+        *g = sparse;
+    }
+    free(degree);
+}
+
+/*
+ * Parallel range helper. With MWCP_USE_PTHREADS the range [0, count) is cut
+ * into `threads` contiguous chunks, otherwise the body runs once inline.
+ * Chunk boundaries come from split(), so callers can balance uneven rows.
+ */
+typedef void (*RangeBody)(void* ctx, int begin, int end);
+
+typedef struct {
+    RangeBody body;
+    void* ctx;
+    int begin, end;
+} RangeTask;
+
+static int hardware_threads(void) {
+#if defined(MWCP_USE_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+#else
+    return 1;
+#endif
+}
+
+#ifdef MWCP_USE_PTHREADS
+static void* range_task_main(void* arg) {
+    RangeTask* task = (RangeTask*)arg;
+    task->body(task->ctx, task->begin, task->end);
+    return NULL;
+}
+
+/*
+ * Row index where chunk `part` of `parts` starts when rows of the upper
+ * triangle (row u has n - 1 - u entries) are split into equal areas
+ */
+static int triangle_split(int n, int parts, int part) {
+    if (part <= 0) return 0;
+    if (part >= parts) return n;
+    double total = (double)n * (n - 1) / 2.0;
+    double target = total * part / parts;
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        double area = (double)mid * (2.0 * n - mid - 1) / 2.0;
+        if (area < target) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+#endif
+
+static void parallel_triangle_rows(int n, int threads, RangeBody body, void* ctx) {
+#ifdef MWCP_USE_PTHREADS
+    if (threads > 1 && n > 256) {
+        pthread_t* ids = (pthread_t*)mwcp_malloc((size_t)threads * sizeof(pthread_t));
+        RangeTask* tasks = (RangeTask*)mwcp_malloc((size_t)threads * sizeof(RangeTask));
+        int started = 0;
+        if (ids && tasks) {
+            for (int t = 0; t < threads; t++) {
+                tasks[t].body = body;
+                tasks[t].ctx = ctx;
+                tasks[t].begin = triangle_split(n, threads, t);
+                tasks[t].end = triangle_split(n, threads, t + 1);
+                if (t > 0 && pthread_create(&ids[t], NULL, range_task_main, &tasks[t]) == 0) {
+                    started = t;
+                } else if (t > 0) {
+                    // Could not spawn: run the remaining chunks inline
+                    body(ctx, tasks[t].begin, n);
+                    break;
                 }
             }
-            
-            if (best_clique >= 0 && best_clique < *partition_size) {
-                partition[best_clique][(*clique_sizes)[best_clique]] = node;
-                (*clique_sizes)[best_clique]++;
-            } else {
-                // Create new single-node clique
-                if (*partition_size < n) {
-                    partition[*partition_size] = (int*)calloc(1, sizeof(int));
-                    if (partition[*partition_size]) {
-                        partition[*partition_size][0] = node;
-                        (*clique_sizes)[*partition_size] = 1;
-                        (*partition_size)++;
-                    }
+            body(ctx, tasks[0].begin, tasks[0].end);
+            for (int t = 1; t <= started; t++) {
+                pthread_join(ids[t], NULL);
+            }
+            free(ids);
+            free(tasks);
+            return;
+        }
+        free(ids);
+        free(tasks);
+    }
+#else
+    (void)threads;
+#endif
+    body(ctx, 0, n);
+}
+
+/*
+ * Run fn over `count` independent worker records of `size` bytes each, one
+ * thread per record (the caller's thread takes record 0). Without
+ * MWCP_USE_PTHREADS, or if a thread cannot be started, records run inline.
+ */
+typedef void* (*WorkerMain)(void* worker);
+
+static void run_workers(WorkerMain fn, void* records, size_t size, int count) {
+    char* base = (char*)records;
+#ifdef MWCP_USE_PTHREADS
+    if (count > 1) {
+        pthread_t* ids = (pthread_t*)mwcp_malloc((size_t)count * sizeof(pthread_t));
+        char* started = (char*)mwcp_calloc((size_t)count, sizeof(char));
+        if (ids && started) {
+            for (int t = 1; t < count; t++) {
+                started[t] = pthread_create(&ids[t], NULL, fn, base + (size_t)t * size) == 0;
+            }
+            fn(base);
+            for (int t = 1; t < count; t++) {
+                if (started[t]) {
+                    pthread_join(ids[t], NULL);
+                } else {
+                    fn(base + (size_t)t * size);
                 }
             }
+            free(ids);
+            free(started);
+            return;
         }
+        free(ids);
+        free(started);
     }
-    
-    // Simple merge phase with limited iterations
-    int improved = 1;
-    int iterations = 0;
-    while (improved && iterations < 20) { // Reduced iterations
-        improved = 0;
-        iterations++;
-        
-        for (int i = 0; i < *partition_size - 1 && !improved && i < 100; i++) {
-            for (int j = i + 1; j < *partition_size && !improved && j < 100; j++) {
-                if ((*clique_sizes)[i] + (*clique_sizes)[j] <= k) {
-                    // Check if can merge
-                    int can_merge = 1;
-                    for (int a = 0; a < (*clique_sizes)[i] && can_merge; a++) {
-                        for (int b = 0; b < (*clique_sizes)[j] && can_merge; b++) {
-                            if (!are_connected(weights, n, partition[i][a], partition[j][b])) {
-                                can_merge = 0;
-                            }
-                        }
-                    }
-                    
-                    if (can_merge) {
-                        // Calculate benefit
-                        long long benefit = 0;
-                        for (int a = 0; a < (*clique_sizes)[i]; a++) {
-                            for (int b = 0; b < (*clique_sizes)[j]; b++) {
-                                int w = safe_get_weight(weights, n, partition[i][a], partition[j][b]);
-                                if (w != NO_EDGE && w > MIN_WEIGHT && w < -MIN_WEIGHT) {
-                                    benefit += w;
-                                }
-                            }
-                        }
-                        
-                        if (benefit > 0) {
-                            // Merge j into i
-                            int new_size = (*clique_sizes)[i] + (*clique_sizes)[j];
-                            int* new_clique = (int*)calloc(new_size, sizeof(int));
-                            
-                            if (new_clique) {
-                                memcpy(new_clique, partition[i], (*clique_sizes)[i] * sizeof(int));
-                                memcpy(new_clique + (*clique_sizes)[i], partition[j], (*clique_sizes)[j] * sizeof(int));
-                                
-                                free(partition[i]);
-                                partition[i] = new_clique;
-                                (*clique_sizes)[i] = new_size;
-                                
-                                free(partition[j]);
-                                
-                                // Shift remaining cliques
-                                for (int shift = j; shift < *partition_size - 1; shift++) {
-                                    partition[shift] = partition[shift + 1];
-                                    (*clique_sizes)[shift] = (*clique_sizes)[shift + 1];
-                                }
-                                partition[*partition_size - 1] = NULL;
-                                (*partition_size)--;
-                                improved = 1;
-                            }
-                        }
-                    }
+#endif
+    for (int t = 0; t < count; t++) {
+        fn(base + (size_t)t * size);
+    }
+}
+
+/*
+ * Text input loader for the Problem.md format: n - 1 lines, line i holding
+ * the n - 1 - i weights from node i to nodes i + 1 .. n - 1. The file is
+ * memory-mapped (read into one heap buffer where mmap is unavailable), line
+ * bounds are found with memchr, and rows are parsed in parallel straight
+ * into the graph storage: no per-row allocation and no scanf.
+ */
+static inline int text_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*
+ * [begin, end) byte offsets of every non-blank line, two entries per line
+ */
+static size_t* text_line_bounds(const MappedFile* mf, int* lines) {
+    size_t cap = 1024;
+    size_t* bounds = (size_t*)mwcp_malloc(cap * 2 * sizeof(size_t));
+    *lines = 0;
+    const char* p = mf->data;
+    const char* end = mf->data + mf->size;
+    while (bounds && p < end) {
+        const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+        const char* stop = nl ? nl : end;
+        const char* q = p;
+        while (q < stop && text_blank(*q)) q++;
+        if (q < stop) {
+            if (*lines == INT_MAX - 1) {
+                free(bounds);
+                return NULL;
+            }
+            if ((size_t)*lines == cap) {
+                size_t* grown = (size_t*)mwcp_realloc(bounds, cap * 4 * sizeof(size_t));
+                if (!grown) {
+                    free(bounds);
+                    return NULL;
                 }
+                bounds = grown;
+                cap *= 2;
             }
+            bounds[2 * *lines] = (size_t)(q - mf->data);
+            bounds[2 * *lines + 1] = (size_t)(stop - mf->data);
+            (*lines)++;
         }
+        p = stop + 1;
     }
-    
-    free(edges);
-    free(node_assigned);
-    
+    return bounds;
+}
+
+/*
+ * Parse one decimal integer at p after skipping blanks. Returns the position
+ * just past it, or NULL if no well-formed int (followed by a blank or the
+ * end of the line) starts there.
+ */
+static inline const char* scan_int(const char* p, const char* end, int* out) {
+    while (p < end && text_blank(*p)) p++;
+    if (p == end) return NULL;
+    int neg = *p == '-';
+    if (neg || *p == '+') p++;
+    const char* digits = p;
+    long long value = 0;
+    while (p < end && (unsigned)(*p - '0') < 10u) {
+        value = value * 10 + (*p - '0');
+        if (value > (long long)INT_MAX + 1) return NULL;
+        p++;
+    }
+    if (p == digits || (p < end && !text_blank(*p))) return NULL;
+    if (neg) value = -value;
+    if (value > INT_MAX) return NULL;
+    *out = (int)value;
+    return p;
+}
+
+typedef struct {
+    Graph* g;
+    const char* data;
+    const size_t* bounds;
+    int error;              // set when any row is malformed
+} TextParser;
+
+static void text_parse_rows(void* ctx, int begin, int end) {
+    TextParser* tp = (TextParser*)ctx;
+    Graph* g = tp->g;
+    int last = g->n - 1 < end ? g->n - 1 : end;
+    for (int u = begin; u < last; u++) {
+        const char* p = tp->data + tp->bounds[2 * u];
+        const char* stop = tp->data + tp->bounds[2 * u + 1];
+        int* dst = graph_upper_row(g, u);
+        int len = g->n - 1 - u;
+        for (int j = 0; j < len && p; j++) {
+            p = scan_int(p, stop, &dst[j]);
+        }
+        if (p) {
+            while (p < stop && text_blank(*p)) p++;
+        }
+        if (!p || p != stop) {
+            __atomic_store_n(&tp->error, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        graph_finish_row(g, u, 1);
+    }
+}
+
+/*
+ * Build g from an upper-triangular text file; n is the number of non-blank
+ * lines plus one. Returns 0 if the file cannot be read or any line does not
+ * hold exactly the expected number of integers.
+ */
+static int graph_load_text(Graph* g, const char* path, int threads) {
+    MappedFile mf;
+    if (!mapped_file_open(&mf, path)) return 0;
+#if defined(MWCP_HAVE_MMAP) && defined(MADV_SEQUENTIAL)
+    if (mf.map) madvise(mf.map, mf.size, MADV_SEQUENTIAL);
+#endif
+    int lines;
+    size_t* bounds = text_line_bounds(&mf, &lines);
+    int ok = 0;
+    if (bounds && graph_alloc(g, lines + 1)) {
+        TextParser tp;
+        tp.g = g;
+        tp.data = mf.data;
+        tp.bounds = bounds;
+        tp.error = 0;
+        parallel_triangle_rows(g->n, threads, text_parse_rows, &tp);
+        ok = !tp.error;
+        if (ok) {
+            graph_select_layout(g);
+        } else {
+            graph_free(g);
+        }
+    }
+    free(bounds);
+    mapped_file_close(&mf);
+    return ok;
+}
+
+/*
+ * Binary graph format (.mwcp), version 1. All fields are native-endian;
+ * byte_order holds 0x01020304 as written so a foreign file is rejected.
+ * Every section starts on a MWCP_ALIGNMENT boundary so the file can be
+ * mapped and used in place.
+ *
+ * MWCP_TRIANGLE: the strict upper triangle row by row (pair (u, v), u < v,
+ *   at index u * (2n - u - 1) / 2 + v - u - 1), NO_EDGE for missing edges,
+ *   followed by the n x ceil(n / 64) adjacency bitset. With 32-bit weights
+ *   this is exactly GRAPH_PACKED and is loaded without copying.
+ * MWCP_CSR: n + 1 uint64 row starts, then uint32 neighbour ids and their
+ *   weights, upper triangle only (each edge once, from its lower endpoint),
+ *   sorted by neighbour. Chosen by the converter when it is smaller.
+ */
+#define MWCP_VERSION 1
+#define MWCP_BYTE_ORDER 0x01020304u
+#define MWCP_ALIGNMENT 64
+#define MWCP_TRIANGLE 0
+#define MWCP_CSR 1
+
+typedef struct {
+    char magic[4];              // "MWCP"
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t n;
+    uint32_t weight_bits;       // 8, 16 or 32 (triangle: 16 or 32)
+    uint32_t layout;            // MWCP_TRIANGLE (dense) or MWCP_CSR (sparse)
+    uint64_t edge_count;
+    uint64_t weights_offset;
+    uint64_t adjacency_offset;  // triangle only
+    uint64_t offsets_offset;    // CSR only
+    uint64_t targets_offset;    // CSR only
+} MwcpHeader;
+
+static inline int mwcp_weight_at(const char* base, int bits, size_t i) {
+    if (bits == 8) return ((const int8_t*)base)[i];
+    if (bits == 16) return ((const int16_t*)base)[i];
+    return ((const int32_t*)base)[i];
+}
+
+static int mwcp_write_weights(FILE* f, const int* w, size_t count, int bits) {
+    if (bits == 32) return fwrite(w, sizeof(int32_t), count, f) == count;
+    for (size_t i = 0; i < count; i++) {
+        int8_t w8 = (int8_t)w[i];
+        int16_t w16 = (int16_t)w[i];
+        if (bits == 8 ? fwrite(&w8, 1, 1, f) != 1 : fwrite(&w16, 2, 1, f) != 1) return 0;
+    }
+    return 1;
+}
+
+static int mwcp_pad(FILE* f, uint64_t* pos) {
+    static const char zeros[MWCP_ALIGNMENT] = {0};
+    size_t pad = (size_t)((MWCP_ALIGNMENT - *pos % MWCP_ALIGNMENT) % MWCP_ALIGNMENT);
+    *pos += pad;
+    return fwrite(zeros, 1, pad, f) == pad;
+}
+
+/*
+ * Write g as .mwcp, picking the smaller of the two layouts and the narrowest
+ * weight width that holds every stored value
+ */
+static int graph_save_binary(const Graph* g, const char* path) {
+    int n = g->n;
+    int words = (n + 63) / 64;
+    long long m = 0;
+    int lo = 0, hi = 0;
+    for (int u = 0; u < n; u++) {
+        NeighbourIter it;
+        int v, w;
+        neighbour_iter_init(&it, g, u, u + 1);
+        while (neighbour_iter_next(&it, &v, &w)) {
+            if (w < lo) lo = w;
+            if (w > hi) hi = w;
+            m++;
+        }
+    }
+    int edge_bits = (lo >= INT8_MIN && hi <= INT8_MAX) ? 8 : (lo >= INT16_MIN && hi <= INT16_MAX) ? 16 : 32;
+    
+    MwcpHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "MWCP", 4);
+    h.version = MWCP_VERSION;
+    h.byte_order = MWCP_BYTE_ORDER;
+    h.n = (uint32_t)n;
+    h.edge_count = (uint64_t)m;
+    
+    uint64_t pairs = (uint64_t)n * (n - 1) / 2;
+    uint64_t adj_bytes = (uint64_t)n * words * sizeof(uint64_t);
+    uint64_t triangle_bytes = pairs * sizeof(int32_t) + adj_bytes;
+    uint64_t csr_bytes = (uint64_t)(n + 1) * sizeof(uint64_t) + (uint64_t)m * (sizeof(uint32_t) + edge_bits / 8);
+    uint64_t pos = sizeof(MwcpHeader);
+    pos += (MWCP_ALIGNMENT - pos % MWCP_ALIGNMENT) % MWCP_ALIGNMENT;
+    if (csr_bytes < triangle_bytes) {
+        h.layout = MWCP_CSR;
+        h.weight_bits = (uint32_t)edge_bits;
+        h.offsets_offset = pos;
+        pos += (uint64_t)(n + 1) * sizeof(uint64_t);
+        pos += (MWCP_ALIGNMENT - pos % MWCP_ALIGNMENT) % MWCP_ALIGNMENT;
+        h.targets_offset = pos;
+        pos += (uint64_t)m * sizeof(uint32_t);
+        pos += (MWCP_ALIGNMENT - pos % MWCP_ALIGNMENT) % MWCP_ALIGNMENT;
+        h.weights_offset = pos;
+    } else {
+        h.layout = MWCP_TRIANGLE;
+        h.weight_bits = 32;
+        h.weights_offset = pos;
+        pos += pairs * sizeof(int32_t);
+        pos += (MWCP_ALIGNMENT - pos % MWCP_ALIGNMENT) % MWCP_ALIGNMENT;
+        h.adjacency_offset = pos;
+    }
+    
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+    int* row = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    uint32_t* ids = (uint32_t*)mwcp_malloc((size_t)n * sizeof(uint32_t));
+    pos = sizeof(MwcpHeader);
+    int ok = row && ids && fwrite(&h, sizeof(h), 1, f) == 1 && mwcp_pad(f, &pos);
+    
+    if (ok && h.layout == MWCP_TRIANGLE) {
+        for (int u = 0; u < n - 1 && ok; u++) {
+            int len = n - 1 - u;
+            for (int j = 0; j < len; j++) {
+                row[j] = graph_weight(g, u, u + 1 + j);
+            }
+            ok = mwcp_write_weights(f, row, (size_t)len, 32);
+            pos += (uint64_t)len * sizeof(int32_t);
+        }
+        ok = ok && mwcp_pad(f, &pos);
+        if (g->layout != GRAPH_SPARSE) {
+            ok = ok && fwrite(g->adj.bits, sizeof(uint64_t), (size_t)n * words, f) == (size_t)n * words;
+        } else {
+            // Sparse graphs keep no bitset; each row is built from its CSR row
+            uint64_t* bits = ok ? (uint64_t*)mwcp_malloc((size_t)words * sizeof(uint64_t)) : NULL;
+            ok = bits != NULL;
+            for (int u = 0; u < n && ok; u++) {
+                memset(bits, 0, (size_t)words * sizeof(uint64_t));
+                for (size_t e = g->nbr_start[u]; e < g->nbr_start[u + 1]; e++) {
+                    bits[g->nbr[e] >> 6] |= 1ULL << (g->nbr[e] & 63);
+                }
+                ok = fwrite(bits, sizeof(uint64_t), (size_t)words, f) == (size_t)words;
+            }
+            free(bits);
+        }
+    } else if (ok) {
+        // Three passes over the rows: row starts, neighbour ids, weights
+        uint64_t start = 0;
+        for (int pass = 0; pass < 3 && ok; pass++) {
+            for (int u = 0; u < n && ok; u++) {
+                NeighbourIter it;
+                int v, w, len = 0;
+                neighbour_iter_init(&it, g, u, u + 1);
+                while (neighbour_iter_next(&it, &v, &w)) {
+                    ids[len] = (uint32_t)v;
+                    row[len++] = w;
+                }
+                if (pass == 0) {
+                    ok = fwrite(&start, sizeof(uint64_t), 1, f) == 1;
+                    start += (uint64_t)len;
+                } else if (pass == 1) {
+                    ok = fwrite(ids, sizeof(uint32_t), (size_t)len, f) == (size_t)len;
+                } else {
+                    ok = mwcp_write_weights(f, row, (size_t)len, edge_bits);
+                }
+            }
+            if (pass == 0) {
+                ok = ok && fwrite(&start, sizeof(uint64_t), 1, f) == 1;
+                pos += (uint64_t)(n + 1) * sizeof(uint64_t);
+            } else if (pass == 1) {
+                pos += (uint64_t)m * sizeof(uint32_t);
+            }
+            if (pass < 2) ok = ok && mwcp_pad(f, &pos);
+        }
+    }
+    free(row);
+    free(ids);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) remove(path);
+    return ok;
+}
+
+static int mwcp_section_fits(const MappedFile* mf, uint64_t offset, uint64_t count, uint64_t size) {
+    if (offset % MWCP_ALIGNMENT != 0 || offset > mf->size) return 0;
+    return count <= (mf->size - offset) / size;
+}
+
+/*
+ * The in-place triangle trusts the file's adjacency bitset, so check it
+ * against the weights first: bit (u, v) is set exactly when u != v and the
+ * pair has an edge, and the padding bits past n are clear
+ */
+static int mwcp_adjacency_consistent(const uint64_t* bits, const int32_t* w, uint64_t n, uint64_t words) {
+    size_t index = 0;
+    for (uint64_t u = 0; u < n; u++) {
+        const uint64_t* row = bits + u * words;
+        // Columns below u mirror rows already checked; the weights cover the rest
+        for (uint64_t v = 0; v < u; v++) {
+            if (((row[v >> 6] >> (v & 63)) & 1) != ((bits[v * words + (u >> 6)] >> (u & 63)) & 1)) return 0;
+        }
+        if ((row[u >> 6] >> (u & 63)) & 1) return 0;
+        for (uint64_t v = u + 1; v < n; v++) {
+            if ((uint64_t)(w[index++] != NO_EDGE) != ((row[v >> 6] >> (v & 63)) & 1)) return 0;
+        }
+        if ((n & 63) && (row[words - 1] >> (n & 63)) != 0) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Build g from a .mwcp file. A 32-bit triangle whose bitset matches its
+ * weights is used in place (g keeps the mapping); other layouts are
+ * expanded into a regular graph.
+ */
+static int graph_load_binary(Graph* g, const char* path) {
+    MappedFile mf;
+    if (!mapped_file_open(&mf, path)) return 0;
+    MwcpHeader h;
+    if (mf.size < sizeof(h)) {
+        mapped_file_close(&mf);
+        return 0;
+    }
+    memcpy(&h, mf.data, sizeof(h));
+    
+    uint64_t n = h.n;
+    uint64_t words = (n + 63) / 64;
+    uint64_t pairs = n * (n - (n > 0)) / 2;
+    int bits = (int)h.weight_bits;
+    int ok = memcmp(h.magic, "MWCP", 4) == 0 && h.version == MWCP_VERSION &&
+             h.byte_order == MWCP_BYTE_ORDER && n >= 1 && n <= INT_MAX &&
+             (bits == 8 || bits == 16 || bits == 32);
+    if (ok && h.layout == MWCP_TRIANGLE) {
+        ok = bits != 8 && mwcp_section_fits(&mf, h.weights_offset, pairs, (uint64_t)bits / 8) &&
+             mwcp_section_fits(&mf, h.adjacency_offset, n * words, sizeof(uint64_t));
+    } else if (ok && h.layout == MWCP_CSR) {
+        ok = h.edge_count <= pairs && mwcp_section_fits(&mf, h.offsets_offset, n + 1, sizeof(uint64_t)) &&
+             mwcp_section_fits(&mf, h.targets_offset, h.edge_count, sizeof(uint32_t)) &&
+             mwcp_section_fits(&mf, h.weights_offset, h.edge_count, (uint64_t)bits / 8);
+    } else {
+        ok = 0;
+    }
+    if (!ok) {
+        mapped_file_close(&mf);
+        return 0;
+    }
+    
+    const char* weights = mf.data + h.weights_offset;
+    if (h.layout == MWCP_TRIANGLE && bits == 32) {
+        // In place: w and the bitset point into the file
+        if (!mwcp_adjacency_consistent((const uint64_t*)(mf.data + h.adjacency_offset),
+                                       (const int32_t*)weights, n, words)) {
+            mapped_file_close(&mf);
+            return 0;
+        }
+        memset(g, 0, sizeof(Graph));
+        g->n = (int)n;
+        g->layout = GRAPH_PACKED;
+        g->adj.n = (int)n;
+        g->adj.words = (int)words;
+        g->adj.bits = (uint64_t*)(mf.data + h.adjacency_offset);
+        g->w = (int*)weights;
+        g->row_offset = (size_t*)mwcp_malloc((size_t)n * sizeof(size_t));
+        if (!g->row_offset) {
+            mapped_file_close(&mf);
+            return 0;
+        }
+        size_t start = 0;
+        for (int u = 0; u < (int)n; u++) {
+            g->row_offset[u] = start - (size_t)u - 1;
+            start += (size_t)(n - 1 - u);
+        }
+        g->file = mf;
+        return 1;
+    }
+    
+    if (h.layout == MWCP_TRIANGLE) {
+        ok = graph_alloc(g, (int)n);
+        size_t index = 0;
+        for (int u = 0; u < (int)n && ok; u++) {
+            int* dst = graph_upper_row(g, u);
+            for (int v = u + 1; v < (int)n; v++) {
+                *dst++ = mwcp_weight_at(weights, bits, index++);
+            }
+            graph_finish_row(g, u, 0);
+        }
+        if (ok) graph_select_layout(g);
+        mapped_file_close(&mf);
+        return ok;
+    }
+    
+    // CSR: validate rows and count degrees, then build sparse or dense
+    const uint64_t* offsets = (const uint64_t*)(mf.data + h.offsets_offset);
+    const uint32_t* targets = (const uint32_t*)(mf.data + h.targets_offset);
+    size_t* degree = (size_t*)mwcp_calloc((size_t)n + 1, sizeof(size_t));
+    ok = degree && offsets[0] == 0 && offsets[n] == h.edge_count;
+    for (int u = 0; u < (int)n && ok; u++) {
+        uint64_t prev = (uint64_t)u;
+        ok = offsets[u] <= offsets[u + 1] && offsets[u + 1] <= h.edge_count;
+        for (uint64_t e = offsets[u]; e < offsets[u + 1] && ok; e++) {
+            uint64_t v = targets[e];
+            ok = v > prev && v < n;
+            if (ok) {
+                degree[u]++;
+                degree[v]++;
+            }
+            prev = v;
+        }
+    }
+    if (ok && graph_is_sparse((int)n, (long long)h.edge_count)) {
+        ok = graph_alloc_sparse(g, (int)n, degree);
+        for (int u = 0; u < (int)n && ok; u++) {
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; e++) {
+                graph_sparse_append(g, degree, u, (int)targets[e], mwcp_weight_at(weights, bits, e));
+            }
+        }
+    } else if (ok) {
+        ok = graph_alloc(g, (int)n);
+        for (int u = 0; u < (int)n && ok; u++) {
+            int* dst = graph_upper_row(g, u);
+            for (int v = u + 1; v < (int)n; v++) {
+                dst[v - u - 1] = NO_EDGE;
+            }
+            for (uint64_t e = offsets[u]; e < offsets[u + 1]; e++) {
+                dst[targets[e] - u - 1] = mwcp_weight_at(weights, bits, e);
+            }
+            graph_finish_row(g, u, 0);
+        }
+    }
+    free(degree);
+    mapped_file_close(&mf);
+    return ok;
+}
+
+/*
+ * Edge collection: exact per-row counts (bitset popcounts or CSR row lengths), a prefix
+ * sum, then each row is filled independently into its own slice, so memory
+ * is exactly one Edge per input edge and rows can be processed in parallel.
+ */
+typedef struct {
+    const Graph* g;
+    long long* offsets;     // n + 1 entries, offsets[u] = first edge of row u
+    Edge* edges;
+} EdgeCollector;
+
+static void edge_count_rows(void* ctx, int begin, int end) {
+    EdgeCollector* ec = (EdgeCollector*)ctx;
+    const Graph* g = ec->g;
+    for (int u = begin; u < end; u++) {
+        long long count = 0;
+        if (g->layout == GRAPH_SPARSE) {
+            NeighbourIter it;
+            neighbour_iter_init(&it, g, u, u + 1);
+            count = (long long)(it.end - it.e);
+        } else {
+            const uint64_t* row = adjacency_row(&g->adj, u);
+            int first = (u + 1) >> 6;
+            for (int i = first; i < g->adj.words; i++) {
+                uint64_t word = row[i];
+                if (i == first) word &= ~0ULL << ((u + 1) & 63);
+                count += __builtin_popcountll(word);
+            }
+        }
+        ec->offsets[u + 1] = count;
+    }
+}
+
+static void edge_fill_rows(void* ctx, int begin, int end) {
+    EdgeCollector* ec = (EdgeCollector*)ctx;
+    for (int u = begin; u < end; u++) {
+        Edge* out = ec->edges + ec->offsets[u];
+        NeighbourIter it;
+        int v, w;
+        neighbour_iter_init(&it, ec->g, u, u + 1);
+        while (neighbour_iter_next(&it, &v, &w)) {
+            out->u = u;
+            out->v = v;
+            out->weight = w;
+            out++;
+        }
+    }
+}
+
+/*
+ * Collect every edge of g into *edges, a buffer_reserve buffer of
+ * *edge_bytes, using *offsets (likewise) for the row offsets. Returns the
+ * edge count, -1 (with *edges NULL) if memory ran out; a graph without
+ * edges still gets a valid buffer.
+ */
+static long long collect_edges(const Graph* g, int threads, Edge** edges, size_t* edge_bytes,
+                               long long** offsets, size_t* offset_bytes) {
+    int n = g->n;
+    EdgeCollector ec;
+    ec.g = g;
+    ec.edges = NULL;
+    ec.offsets = (long long*)buffer_reserve(*offsets, offset_bytes, ((size_t)n + 1) * sizeof(long long));
+    *offsets = ec.offsets;
+    if (!ec.offsets) {
+        free(*edges);
+        *edges = NULL;
+        *edge_bytes = 0;
+        return -1;
+    }
+    
+    ec.offsets[0] = 0;
+    parallel_triangle_rows(n, threads, edge_count_rows, &ec);
+    for (int u = 0; u < n; u++) {
+        ec.offsets[u + 1] += ec.offsets[u];
+    }
+    
+    long long total = ec.offsets[n];
+    ec.edges = (Edge*)buffer_reserve(*edges, edge_bytes, (size_t)total * sizeof(Edge));
+    *edges = ec.edges;
+    if (!ec.edges) return -1;
+    parallel_triangle_rows(n, threads, edge_fill_rows, &ec);
+    return total;
+}
+
+/*
+ * Compare function for sorting edges by weight (descending), ties by (u, v)
+ * so that every sort of the same edges yields the same order
+ */
+int compare_edges(const void* a, const void* b) {
+    if (a == NULL || b == NULL) return 0;
+    Edge* ea = (Edge*)a;
+    Edge* eb = (Edge*)b;
+    if (eb->weight > ea->weight) return 1;
+    if (eb->weight < ea->weight) return -1;
+    if (ea->u != eb->u) return ea->u < eb->u ? -1 : 1;
+    if (ea->v != eb->v) return ea->v < eb->v ? -1 : 1;
+    return 0;
+}
+
+/*
+ * Edge radix sort: stable LSD passes over 8-bit digits of a key that grows
+ * as the weight falls, measured from the smallest key present so only the
+ * digits spanning the actual weight range are visited. Collected edges are
+ * already in (u, v) order, so stability gives the compare_edges order.
+ * Each pass builds per-chunk histograms and scatters chunks in parallel.
+ */
+#define RADIX_PARALLEL_MIN (1 << 16)
+
+static inline uint32_t edge_key(const Edge* e) {
+    return ~((uint32_t)e->weight ^ 0x80000000u);
+}
+
+typedef struct {
+    const Edge* src;
+    Edge* dst;
+    long long begin, end;
+    uint32_t base;              // smallest key of the edges being sorted
+    int shift;
+    int scatter;                // 0: count digits, 1: scatter
+    long long slot[256];        // digit histogram, then next output slot
+} RadixChunk;
+
+static void* radix_chunk_main(void* arg) {
+    RadixChunk* c = (RadixChunk*)arg;
+    if (!c->scatter) {
+        memset(c->slot, 0, sizeof(c->slot));
+        for (long long i = c->begin; i < c->end; i++) {
+            c->slot[((edge_key(&c->src[i]) - c->base) >> c->shift) & 0xFF]++;
+        }
+    } else {
+        for (long long i = c->begin; i < c->end; i++) {
+            c->dst[c->slot[((edge_key(&c->src[i]) - c->base) >> c->shift) & 0xFF]++] = c->src[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * One stable pass on the digit at `shift`, src -> dst. start[0 .. 256]
+ * receives the digit boundaries. Returns 1 if the edges were scattered,
+ * 0 if they all share the digit (nothing moves), -1 if memory ran out.
+ */
+static int radix_pass(const Edge* src, Edge* dst, long long count, uint32_t base, int shift,
+                      int threads, long long* start) {
+    int parts = count >= RADIX_PARALLEL_MIN && threads > 1 ? threads : 1;
+    RadixChunk single;
+    RadixChunk* chunks = parts > 1 ? (RadixChunk*)mwcp_malloc((size_t)parts * sizeof(RadixChunk)) : &single;
+    if (!chunks) return -1;
+    for (int t = 0; t < parts; t++) {
+        chunks[t].src = src;
+        chunks[t].dst = dst;
+        chunks[t].begin = count * t / parts;
+        chunks[t].end = count * (t + 1) / parts;
+        chunks[t].base = base;
+        chunks[t].shift = shift;
+        chunks[t].scatter = 0;
+    }
+    run_workers(radix_chunk_main, chunks, sizeof(RadixChunk), parts);
+    
+    // Digit boundaries, and where each chunk's share of a digit begins
+    long long total = 0;
+    int uniform = 0;
+    for (int d = 0; d < 256; d++) {
+        start[d] = total;
+        for (int t = 0; t < parts; t++) {
+            long long c = chunks[t].slot[d];
+            chunks[t].slot[d] = total;
+            total += c;
+        }
+        if (total - start[d] == count) uniform = 1;
+    }
+    start[256] = total;
+    if (!uniform) {
+        for (int t = 0; t < parts; t++) {
+            chunks[t].scatter = 1;
+        }
+        run_workers(radix_chunk_main, chunks, sizeof(RadixChunk), parts);
+    }
+    if (chunks != &single) free(chunks);
+    return !uniform;
+}
+
+/*
+ * Sort edges on the low `bits` bits of (key - base) using `scratch` (same
+ * length). Returns 0 if memory ran out; the edges are then unsorted.
+ */
+static int radix_sort_edges(Edge* edges, Edge* scratch, long long count, uint32_t base, int bits, int threads) {
+    Edge* src = edges;
+    Edge* dst = scratch;
+    long long start[257];
+    int ok = 1;
+    for (int shift = 0; shift < bits && ok; shift += 8) {
+        int moved = radix_pass(src, dst, count, base, shift, threads, start);
+        if (moved > 0) {
+            Edge* tmp = src;
+            src = dst;
+            dst = tmp;
+        }
+        ok = moved >= 0;
+    }
+    if (src != edges) memcpy(edges, src, (size_t)count * sizeof(Edge));
+    return ok;
+}
+
+/*
+ * Node-to-clique gain table. For every node v and every clique C holding at
+ * least one neighbour of v it stores sum(w(v, x) for x in C) and the number
+ * of such neighbours. v can join C iff count == |C|, and the weight gained
+ * by doing so is sum, so evaluating a move is an O(1) hash lookup. Each row
+ * is a small open-addressing table keyed by clique id.
+ */
+typedef struct {
+    int clique;         // -1 marks an empty slot
+    int count;          // members of clique adjacent to the node
+    long long sum;      // summed weight to those members
+} GainEntry;
+
+typedef struct {
+    GainEntry* slots;
+    int cap;            // power of two, 0 until first insert
+    int used;
+} GainRow;
+
+typedef struct {
+    const Graph* g;
+    GainRow* rows;      // one per node
+    int capacity;       // rows allocated, >= g->n when reused for a smaller graph
+} GainTable;
+
+static inline unsigned gain_hash(int clique, int cap) {
+    return ((unsigned)clique * 2654435761u) & (unsigned)(cap - 1);
+}
+
+static inline GainEntry* gain_lookup(const GainTable* gt, int v, int clique) {
+    const GainRow* row = &gt->rows[v];
+    STAT_ADD(gain_evaluations, 1);
+    if (row->cap == 0) return NULL;
+    unsigned i = gain_hash(clique, row->cap);
+    while (row->slots[i].clique != -1) {
+        if (row->slots[i].clique == clique) return &row->slots[i];
+        i = (i + 1) & (unsigned)(row->cap - 1);
+    }
+    return NULL;
+}
+
+static int gain_row_grow(GainRow* row) {
+    int cap = row->cap ? row->cap * 2 : 4;
+    GainEntry* slots = (GainEntry*)mwcp_malloc((size_t)cap * sizeof(GainEntry));
+    if (!slots) return 0;
+    for (int i = 0; i < cap; i++) slots[i].clique = -1;
+    for (int i = 0; i < row->cap; i++) {
+        if (row->slots[i].clique == -1) continue;
+        unsigned j = gain_hash(row->slots[i].clique, cap);
+        while (slots[j].clique != -1) j = (j + 1) & (unsigned)(cap - 1);
+        slots[j] = row->slots[i];
+    }
+    free(row->slots);
+    row->slots = slots;
+    row->cap = cap;
+    return 1;
+}
+
+static GainEntry* gain_upsert(GainTable* gt, int v, int clique) {
+    GainRow* row = &gt->rows[v];
+    GainEntry* e = gain_lookup(gt, v, clique);
+    if (e) return e;
+    if ((row->used + 1) * 4 > row->cap * 3 && !gain_row_grow(row)) return NULL;
+    unsigned i = gain_hash(clique, row->cap);
+    while (row->slots[i].clique != -1) i = (i + 1) & (unsigned)(row->cap - 1);
+    row->slots[i].clique = clique;
+    row->slots[i].count = 0;
+    row->slots[i].sum = 0;
+    row->used++;
+    return &row->slots[i];
+}
+
+/*
+ * Delete an entry with backward-shift so probe chains stay tombstone free
+ */
+static void gain_erase(GainTable* gt, int v, GainEntry* e) {
+    GainRow* row = &gt->rows[v];
+    unsigned mask = (unsigned)(row->cap - 1);
+    unsigned hole = (unsigned)(e - row->slots);
+    unsigned i = (hole + 1) & mask;
+    while (row->slots[i].clique != -1) {
+        unsigned home = gain_hash(row->slots[i].clique, row->cap);
+        // Move slot i into the hole if its home does not lie in (hole, i]
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            row->slots[hole] = row->slots[i];
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+    row->slots[hole].clique = -1;
+    row->used--;
+}
+
+static void gain_row_clear(GainRow* row) {
+    for (int i = 0; i < row->cap; i++) row->slots[i].clique = -1;
+    row->used = 0;
+}
+
+static int gain_table_init(GainTable* gt, const Graph* g) {
+    gt->g = g;
+    gt->rows = (GainRow*)mwcp_calloc((size_t)g->n, sizeof(GainRow));
+    gt->capacity = gt->rows ? g->n : 0;
+    return gt->rows != NULL;
+}
+
+static void gain_table_free(GainTable* gt) {
+    if (!gt->rows) return;
+    for (int v = 0; v < gt->capacity; v++) {
+        free(gt->rows[v].slots);
+    }
+    free(gt->rows);
+    gt->rows = NULL;
+}
+
+/*
+ * Account for node joining (sign = +1) or leaving (sign = -1) a clique:
+ * every neighbour of node sees its entry for that clique change.
+ */
+static int gain_table_update(GainTable* gt, int node, int clique, int sign) {
+    NeighbourIter it;
+    int x, w;
+    neighbour_iter_init(&it, gt->g, node, 0);
+    while (neighbour_iter_next(&it, &x, &w)) {
+        if (sign > 0) {
+            GainEntry* e = gain_upsert(gt, x, clique);
+            if (!e) return 0;
+            e->count++;
+            e->sum += w;
+        } else {
+            GainEntry* e = gain_lookup(gt, x, clique);
+            if (--e->count == 0) {
+                gain_erase(gt, x, e);
+            } else {
+                e->sum -= w;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * Small seeded generator (xorshift64*) for randomized tie-breaking. Each
+ * solve owns its own state, so runs are reproducible per seed.
+ */
+typedef struct {
+    uint64_t state;
+} Rng;
+
+static void rng_seed(Rng* rng, uint64_t seed) {
+    // splitmix64 scramble so nearby seeds give unrelated streams
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    rng->state = (z ^ (z >> 31)) | 1;
+}
+
+static inline uint64_t rng_next(Rng* rng) {
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return rng->state * 0x2545F4914F6CDD1DULL;
+}
+
+static inline int rng_below(Rng* rng, int bound) {
+    return (int)(rng_next(rng) % (uint64_t)bound);
+}
+
+static double clock_seconds(void) {
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+/*
+ * Stop condition for the improvement phases: a deadline and/or a flag
+ * another thread may set. Checking is cheap enough for hot loops: the flag
+ * is one relaxed load, the clock is read every BUDGET_CHECK_INTERVAL calls,
+ * and once either fires the answer is latched.
+ */
+#define BUDGET_CHECK_INTERVAL 256
+
+typedef struct {
+    double deadline;                // clock_seconds() value, 0 for none
+    const volatile int* cancel;     // stop once nonzero; NULL for none
+    unsigned ticks;
+    int expired;
+} Budget;
+
+// Exact check: reads the clock every time
+static int budget_check_now(Budget* b) {
+    if (!b->expired) {
+        b->expired = (b->cancel && __atomic_load_n(b->cancel, __ATOMIC_RELAXED)) ||
+                     (b->deadline > 0 && clock_seconds() > b->deadline);
+    }
+    return b->expired;
+}
+
+static inline int budget_expired(Budget* b) {
+    if (b->expired) return 1;
+    if (b->cancel && __atomic_load_n(b->cancel, __ATOMIC_RELAXED)) {
+        b->expired = 1;
+    } else if (b->deadline > 0 && (++b->ticks & (BUDGET_CHECK_INTERVAL - 1)) == 0) {
+        b->expired = clock_seconds() > b->deadline;
+    }
+    return b->expired;
+}
+
+typedef struct MergeScratch MergeScratch;
+static void merge_scratch_free(MergeScratch* m);
+
+/*
+ * Working partition with stable clique ids. Slots emptied by merges or
+ * moves stay empty until export, so the gain table never has to be re-keyed.
+ */
+typedef struct {
+    int n, k;
+    int count;              // clique ids in use: 0 .. count-1
+    int* clique_of;         // node -> clique id, -1 while unassigned
+    int* pos;               // node -> index in its clique's member array
+    int* size;              // clique -> member count
+    int* cap;               // clique -> member array capacity
+    int** members;          // clique -> members
+    long long* weight;      // clique -> internal edge weight
+    int* free_ids;          // emptied clique ids available for reuse
+    char* in_free;          // clique -> listed in free_ids
+    int free_count;
+    int assigned;           // nodes currently in a clique
+    int* order;             // node visiting order of the construction phases
+    int* cand;              // expansion scratch: candidate nodes
+    long long* cand_gain;   // expansion scratch: their gain to the clique
+    Rng* rng;               // NULL for the deterministic index-order pipeline
+    Budget* budget;         // NULL runs every phase to completion; when it expires
+                            // Phases 1-2 may leave nodes unassigned
+    const Graph* g;
+    GainTable gains;
+    int capacity;           // node slots allocated, >= n (see work_partition_prepare)
+    MergeScratch* merge;    // Phase 3 buffers, kept from the first merge on
+} WorkPartition;
+
+static void work_partition_free(WorkPartition* wp) {
+    if (wp->members) {
+        for (int c = 0; c < wp->capacity; c++) {
+            free(wp->members[c]);
+        }
+    }
+    free(wp->members);
+    free(wp->clique_of);
+    free(wp->pos);
+    free(wp->size);
+    free(wp->cap);
+    free(wp->weight);
+    free(wp->free_ids);
+    free(wp->in_free);
+    free(wp->order);
+    free(wp->cand);
+    free(wp->cand_gain);
+    gain_table_free(&wp->gains);
+    merge_scratch_free(wp->merge);
+    memset(wp, 0, sizeof(WorkPartition));
+}
+
+static int work_partition_init(WorkPartition* wp, const Graph* g, int k) {
+    int n = g->n;
+    memset(wp, 0, sizeof(WorkPartition));
+    wp->n = n;
+    wp->k = k;
+    wp->g = g;
+    wp->capacity = n;
+    wp->clique_of = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    wp->pos = (int*)mwcp_calloc((size_t)n, sizeof(int));
+    wp->size = (int*)mwcp_calloc((size_t)n, sizeof(int));
+    wp->cap = (int*)mwcp_calloc((size_t)n, sizeof(int));
+    wp->members = (int**)mwcp_calloc((size_t)n, sizeof(int*));
+    wp->weight = (long long*)mwcp_calloc((size_t)n, sizeof(long long));
+    wp->free_ids = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    wp->in_free = (char*)mwcp_calloc((size_t)n, sizeof(char));
+    wp->order = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    wp->cand = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    wp->cand_gain = (long long*)mwcp_malloc((size_t)n * sizeof(long long));
+    if (!wp->clique_of || !wp->pos || !wp->size || !wp->cap || !wp->members ||
+        !wp->weight || !wp->free_ids || !wp->in_free || !wp->order ||
+        !wp->cand || !wp->cand_gain || !gain_table_init(&wp->gains, g)) {
+        work_partition_free(wp);
+        return 0;
+    }
+    for (int v = 0; v < n; v++) {
+        wp->clique_of[v] = -1;
+        wp->order[v] = v;
+    }
+    return 1;
+}
+
+/*
+ * Empty the partition for another solve, keeping every allocation. With an
+ * rng the construction order is reshuffled, otherwise it is index order.
+ */
+static void work_partition_reset(WorkPartition* wp, Rng* rng) {
+    for (int c = 0; c < wp->count; c++) {
+        wp->size[c] = 0;
+        wp->weight[c] = 0;
+        wp->in_free[c] = 0;
+    }
+    for (int v = 0; v < wp->n; v++) {
+        gain_row_clear(&wp->gains.rows[v]);
+        wp->clique_of[v] = -1;
+        wp->order[v] = v;
+    }
+    wp->count = 0;
+    wp->free_count = 0;
+    wp->assigned = 0;
+    wp->rng = rng;
+    if (rng) {
+        for (int v = wp->n - 1; v > 0; v--) {
+            int j = rng_below(rng, v + 1);
+            int tmp = wp->order[v];
+            wp->order[v] = wp->order[j];
+            wp->order[j] = tmp;
+        }
+    }
+}
+
+/*
+ * Ready a partition that is zeroed or was used before for a solve of g,
+ * keeping its buffers (gain rows, member arrays, merge scratch) when g fits
+ * in them. The partition is left empty, in index order.
+ */
+static int work_partition_prepare(WorkPartition* wp, const Graph* g, int k) {
+    if (wp->capacity < g->n) {
+        work_partition_free(wp);
+        return work_partition_init(wp, g, k);
+    }
+    // Clear under the old size, then switch to g
+    work_partition_reset(wp, NULL);
+    wp->n = g->n;
+    wp->k = k;
+    wp->g = g;
+    wp->gains.g = g;
+    wp->budget = NULL;
+    for (int v = 0; v < wp->n; v++) {
+        wp->clique_of[v] = -1;
+        wp->order[v] = v;
+    }
+    return 1;
+}
+
+/*
+ * Weight node would add to clique c (0 when nothing in c is adjacent)
+ */
+static inline long long work_gain(const WorkPartition* wp, int node, int c) {
+    const GainEntry* e = gain_lookup(&wp->gains, node, c);
+    return e ? e->sum : 0;
+}
+
+/*
+ * Whether node (not currently in c) is adjacent to every member of c
+ */
+static inline int work_fits(const WorkPartition* wp, int node, int c) {
+    if (wp->size[c] == 0) return 1;
+    const GainEntry* e = gain_lookup(&wp->gains, node, c);
+    return e != NULL && e->count == wp->size[c];
+}
+
+/*
+ * Open a new empty clique slot, reusing an emptied id when there is one.
+ * Listed ids that were refilled directly (e.g. by a swap) are skipped.
+ */
+static int work_new_clique(WorkPartition* wp) {
+    while (wp->free_count > 0) {
+        int c = wp->free_ids[--wp->free_count];
+        wp->in_free[c] = 0;
+        if (wp->size[c] == 0) return c;
+    }
+    if (wp->count >= wp->n) return -1;
+    int c = wp->count++;
+    wp->size[c] = 0;
+    wp->weight[c] = 0;
+    return c;
+}
+
+static int work_add(WorkPartition* wp, int node, int c) {
+    if (wp->size[c] == wp->cap[c]) {
+        int cap = wp->cap[c] ? wp->cap[c] * 2 : 4;
+        if (cap > wp->k) cap = wp->k;
+        int* grown = (int*)mwcp_realloc(wp->members[c], (size_t)cap * sizeof(int));
+        if (!grown) return 0;
+        wp->members[c] = grown;
+        wp->cap[c] = cap;
+    }
+    wp->weight[c] += work_gain(wp, node, c);
+    wp->pos[node] = wp->size[c];
+    wp->members[c][wp->size[c]++] = node;
+    wp->clique_of[node] = c;
+    wp->assigned++;
+    return gain_table_update(&wp->gains, node, c, +1);
+}
+
+static void work_remove(WorkPartition* wp, int node) {
+    int c = wp->clique_of[node];
+    int last = wp->members[c][wp->size[c] - 1];
+    wp->members[c][wp->pos[node]] = last;
+    wp->pos[last] = wp->pos[node];
+    wp->size[c]--;
+    wp->clique_of[node] = -1;
+    wp->assigned--;
+    gain_table_update(&wp->gains, node, c, -1);
+    wp->weight[c] -= work_gain(wp, node, c);
+    if (wp->size[c] == 0 && !wp->in_free[c]) {
+        wp->in_free[c] = 1;
+        wp->free_ids[wp->free_count++] = c;
+    }
+}
+
+/*
+ * Objective: total intra-clique weight over total clique membership
+ */
+static double work_objective(const WorkPartition* wp) {
+    long long total = 0;
+    long long nodes = 0;
+    for (int c = 0; c < wp->count; c++) {
+        total += wp->weight[c];
+        nodes += wp->size[c];
+    }
+    return nodes > 0 ? (double)total / (double)nodes : 0.0;
+}
+
+/*
+ * Candidate cliques for Phase 1: for every root vertex, the heaviest clique
+ * of at most k nodes containing it, found by a Bron-Kerbosch search with
+ * Tomita pivoting. To keep each search bit-parallel in one word, the root's
+ * neighbourhood is cut to its CANDIDATE_NEIGHBOURS heaviest positive edges;
+ * branches are pruned when even the best completion cannot beat the
+ * heaviest clique found so far for that root, and each root gets at most
+ * CANDIDATE_BUDGET recursive calls.
+ */
+#define CANDIDATE_NEIGHBOURS 64
+#ifndef CANDIDATE_BUDGET
+#define CANDIDATE_BUDGET 2000
+#endif
+
+typedef struct {
+    long long weight;
+    int size;
+    int first;              // index of the first member in the member pool
+} CliqueCandidate;
+
+typedef struct {
+    int m;                                  // local vertices
+    int k;
+    int ids[CANDIDATE_NEIGHBOURS];          // local -> graph node
+    uint64_t adj[CANDIDATE_NEIGHBOURS];
+    int w[CANDIDATE_NEIGHBOURS][CANDIDATE_NEIGHBOURS];
+    int max_positive[CANDIDATE_NEIGHBOURS]; // largest positive local weight
+    long long budget;
+    long long best_weight;
+    uint64_t best_set;
+} CliqueSearch;
+
+/*
+ * Upper bound on what adding up to `slots` members of P can still add,
+ * given gain[x] = weight from x to the current clique. Values are kept
+ * doubled and halved once, rounding up, so the bound never undercuts the
+ * true optimum.
+ */
+static long long clique_search_bound(const CliqueSearch* cs, const long long* gain, uint64_t P, int slots) {
+    long long top[CANDIDATE_NEIGHBOURS];
+    int kept = 0;
+    while (P) {
+        int x = __builtin_ctzll(P);
+        P &= P - 1;
+        // Each added pair is shared by two members, hence the half
+        long long value = 2 * gain[x] + (long long)(slots - 1) * cs->max_positive[x];
+        if (value <= 0) continue;
+        int i;
+        if (kept < slots) {
+            i = kept++;
+        } else if (top[slots - 1] < value) {
+            i = slots - 1;
+        } else {
+            continue;
+        }
+        while (i > 0 && top[i - 1] < value) {
+            top[i] = top[i - 1];
+            i--;
+        }
+        top[i] = value;
+    }
+    long long sum = 0;
+    for (int i = 0; i < kept; i++) sum += top[i];
+    return (sum + 1) / 2;
+}
+
+static void clique_search(CliqueSearch* cs, uint64_t R, int size, long long weight,
+                          const long long* gain, uint64_t P, uint64_t X) {
+    if (weight > cs->best_weight) {
+        cs->best_weight = weight;
+        cs->best_set = R;
+    }
+    if (size >= cs->k || P == 0 || --cs->budget < 0) return;
+    if (weight + clique_search_bound(cs, gain, P, cs->k - size) <= cs->best_weight) return;
+    
+    // Tomita pivot: the vertex of P u X with the most neighbours in P
+    uint64_t PX = P | X;
+    int pivot = __builtin_ctzll(PX);
+    int pivot_hits = -1;
+    while (PX) {
+        int u = __builtin_ctzll(PX);
+        PX &= PX - 1;
+        int hits = __builtin_popcountll(P & cs->adj[u]);
+        if (hits > pivot_hits) {
+            pivot_hits = hits;
+            pivot = u;
+        }
+    }
+    
+    uint64_t branch = P & ~cs->adj[pivot];
+    long long next_gain[CANDIDATE_NEIGHBOURS];
+    while (branch) {
+        int x = __builtin_ctzll(branch);
+        uint64_t bit = 1ULL << x;
+        branch &= branch - 1;
+        
+        uint64_t next_P = P & cs->adj[x];
+        uint64_t m = next_P;
+        while (m) {
+            int y = __builtin_ctzll(m);
+            m &= m - 1;
+            next_gain[y] = gain[y] + cs->w[x][y];
+        }
+        clique_search(cs, R | bit, size + 1, weight + gain[x], next_gain, next_P, X & cs->adj[x]);
+        P &= ~bit;
+        X |= bit;
+        if (cs->budget < 0) return;
+    }
+}
+
+/*
+ * Heaviest clique containing root; writes its members and returns its size
+ */
+static int best_clique_for_root(const Graph* g, int k, int root, CliqueSearch* cs, int* members, long long* weight) {
+    // Keep the heaviest positive neighbours in a min-heap on weight
+    int heap_w[CANDIDATE_NEIGHBOURS];
+    int count = 0;
+    NeighbourIter it;
+    int v, w;
+    neighbour_iter_init(&it, g, root, 0);
+    while (neighbour_iter_next(&it, &v, &w)) {
+        if (w <= 0 || (count == CANDIDATE_NEIGHBOURS && w <= heap_w[0])) continue;
+        int pos;
+        if (count < CANDIDATE_NEIGHBOURS) {
+            pos = count++;
+            while (pos > 0 && heap_w[(pos - 1) / 2] > w) {
+                heap_w[pos] = heap_w[(pos - 1) / 2];
+                cs->ids[pos] = cs->ids[(pos - 1) / 2];
+                pos = (pos - 1) / 2;
+            }
+        } else {
+            pos = 0;
+            for (;;) {
+                int child = 2 * pos + 1;
+                if (child >= count) break;
+                if (child + 1 < count && heap_w[child + 1] < heap_w[child]) child++;
+                if (heap_w[child] >= w) break;
+                heap_w[pos] = heap_w[child];
+                cs->ids[pos] = cs->ids[child];
+                pos = child;
+            }
+        }
+        heap_w[pos] = w;
+        cs->ids[pos] = v;
+    }
+    
+    long long gain[CANDIDATE_NEIGHBOURS];
+    uint64_t P = count == 64 ? ~0ULL : (1ULL << count) - 1;
+    cs->m = count;
+    cs->k = k;
+    for (int a = 0; a < count; a++) {
+        cs->adj[a] = 0;
+        cs->max_positive[a] = 0;
+        gain[a] = heap_w[a];
+    }
+    for (int a = 0; a < count; a++) {
+        for (int b = a + 1; b < count; b++) {
+            int w = 0;
+            if (graph_adjacent(g, cs->ids[a], cs->ids[b])) {
+                w = graph_weight(g, cs->ids[a], cs->ids[b]);
+                cs->adj[a] |= 1ULL << b;
+                cs->adj[b] |= 1ULL << a;
+                if (w > cs->max_positive[a]) cs->max_positive[a] = w;
+                if (w > cs->max_positive[b]) cs->max_positive[b] = w;
+            }
+            cs->w[a][b] = cs->w[b][a] = w;
+        }
+    }
+    
+    cs->budget = CANDIDATE_BUDGET;
+    cs->best_weight = 0;
+    cs->best_set = 0;
+    clique_search(cs, 0, 1, 0, gain, P, 0);
+    
+    int size = 0;
+    members[size++] = root;
+    for (uint64_t m = cs->best_set; m; m &= m - 1) {
+        members[size++] = cs->ids[__builtin_ctzll(m)];
+    }
+    *weight = cs->best_weight;
+    return size;
+}
+
+static int compare_candidates(const void* a, const void* b) {
+    const CliqueCandidate* ca = (const CliqueCandidate*)a;
+    const CliqueCandidate* cb = (const CliqueCandidate*)b;
+    if (cb->weight > ca->weight) return 1;
+    if (cb->weight < ca->weight) return -1;
+    return ca->first - cb->first;
+}
+
+/*
+ * Everything Phase 1 seeds from. A fully sorted set is shared read-only
+ * between solves of the same graph; a lazily ordered one belongs to a
+ * single solve, which finishes its edge order only as far as Phase 1 reads.
+ */
+#define SEED_EDGES_SORTED 0
+#define SEED_EDGES_LAZY 1
+
+typedef struct {
+    Edge* edges;                    // by weight, descending; NULL if memory ran out
+    long long edge_count;
+    long long ready;                // edges[0 .. ready) are in final order
+    Edge* scratch;                  // lazy: radix scratch for the unsorted buckets
+    long long* bucket_start;        // lazy: 257 boundaries of the top-digit buckets
+    int next_bucket;                // lazy: first bucket not sorted yet
+    int bucket_bits;                // lazy: key bits left to sort inside a bucket
+    uint32_t key_base;
+    CliqueCandidate* candidates;    // by weight, descending; NULL if memory ran out
+    int candidate_count;
+    int* candidate_members;
+    int threads;                    // workers for edge collection and sorting
+    int keep;                       // keep every buffer for the next seed_set_rebuild
+    size_t edge_bytes, scratch_bytes, candidate_bytes, member_bytes, offset_bytes, search_bytes;
+    long long* edge_offsets;        // collection scratch
+    CliqueSearch* search;           // enumeration state
+} SeedSet;
+
+static void seed_set_free(SeedSet* seeds) {
+    free(seeds->edges);
+    free(seeds->scratch);
+    free(seeds->bucket_start);
+    free(seeds->candidates);
+    free(seeds->candidate_members);
+    free(seeds->edge_offsets);
+    free(seeds->search);
+    memset(seeds, 0, sizeof(SeedSet));
+}
+
+/*
+ * Order the collected edges. Only the key bits spanning the weight range
+ * are sorted on. In lazy mode a single pass splits the edges into up to 256
+ * buckets on the top digit, heaviest first, and seed_edges_reach sorts
+ * each bucket on first access, so edges Phase 1 never reaches stay unsorted.
+ */
+static void seed_edges_order(SeedSet* seeds, int mode) {
+    long long count = seeds->edge_count;
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (long long i = 0; i < count; i++) {
+        uint32_t key = edge_key(&seeds->edges[i]);
+        if (key < lo) lo = key;
+        if (key > hi) hi = key;
+    }
+    int bits = 0;
+    while (bits < 32 && ((hi - lo) >> bits) != 0) bits++;
+    seeds->ready = count;
+    seeds->key_base = lo;
+    
+    Edge* scratch = (Edge*)buffer_reserve(seeds->scratch, &seeds->scratch_bytes, (size_t)count * sizeof(Edge));
+    seeds->scratch = scratch;
+    if (scratch && mode == SEED_EDGES_LAZY && bits > 8) {
+        long long start[257];
+        if (!seeds->bucket_start) seeds->bucket_start = (long long*)mwcp_malloc(257 * sizeof(long long));
+        int shift = bits - 8;
+        if (seeds->bucket_start &&
+            radix_pass(seeds->edges, scratch, count, lo, shift, seeds->threads, start) > 0) {
+            memcpy(seeds->bucket_start, start, sizeof(start));
+            // The split copy becomes the edge array, the collected one the scratch
+            size_t bytes = seeds->scratch_bytes;
+            seeds->scratch = seeds->edges;
+            seeds->scratch_bytes = seeds->edge_bytes;
+            seeds->edges = scratch;
+            seeds->edge_bytes = bytes;
+            seeds->bucket_bits = shift;
+            seeds->ready = 0;
+            return;
+        }
+    }
+    if (!scratch || !radix_sort_edges(seeds->edges, scratch, count, lo, bits, seeds->threads)) {
+        qsort(seeds->edges, (size_t)count, sizeof(Edge), compare_edges);
+    }
+    if (!seeds->keep) {
+        free(scratch);
+        seeds->scratch = NULL;
+        seeds->scratch_bytes = 0;
+    }
+}
+
+/*
+ * Make sure edges[index] is in final order; returns 0 past the last edge
+ */
+static int seed_edges_reach(SeedSet* seeds, long long index) {
+    while (index >= seeds->ready && seeds->ready < seeds->edge_count) {
+        STAT_ENTER(MWCP_PHASE_SORT);
+        int b = seeds->next_bucket++;
+        long long first = seeds->bucket_start[b];
+        long long len = seeds->bucket_start[b + 1] - first;
+        if (len > 1 && !radix_sort_edges(seeds->edges + first, seeds->scratch + first, len,
+                                         seeds->key_base, seeds->bucket_bits, seeds->threads)) {
+            qsort(seeds->edges + first, (size_t)len, sizeof(Edge), compare_edges);
+        }
+        seeds->ready = seeds->bucket_start[b + 1];
+        STAT_LEAVE();
+    }
+    if (seeds->ready == seeds->edge_count && seeds->scratch && !seeds->keep) {
+        free(seeds->scratch);
+        seeds->scratch = NULL;
+        seeds->scratch_bytes = 0;
+    }
+    return index < seeds->ready;
+}
+
+/*
+ * Collect and order the edges, then enumerate candidate cliques; an
+ * optional budget cuts the enumeration short, keeping what was found.
+ * The set must be zeroed or built before; with seeds->keep set its buffers
+ * are reused and kept for the next rebuild.
+ */
+static void seed_set_rebuild(SeedSet* seeds, const Graph* g, int k, int mode, Budget* budget) {
+    int n = g->n;
+    int per_root = k < CANDIDATE_NEIGHBOURS + 1 ? k : CANDIDATE_NEIGHBOURS + 1;
+    seeds->ready = 0;
+    seeds->next_bucket = 0;
+    seeds->bucket_bits = 0;
+    seeds->key_base = 0;
+    seeds->candidate_count = 0;
+    
+    // Count, collect and order every edge
+    STAT_ENTER(MWCP_PHASE_COLLECT);
+    seeds->edge_count = collect_edges(g, seeds->threads, &seeds->edges, &seeds->edge_bytes,
+                                      &seeds->edge_offsets, &seeds->offset_bytes);
+    if (!seeds->keep) {
+        free(seeds->edge_offsets);
+        seeds->edge_offsets = NULL;
+        seeds->offset_bytes = 0;
+    }
+    if (!seeds->edges) seeds->edge_count = 0;
+    STAT_ADD(edges_collected, seeds->edge_count);
+    STAT_LEAVE();
+    STAT_ENTER(MWCP_PHASE_SORT);
+    if (seeds->edge_count > 1) {
+        seed_edges_order(seeds, mode);
+    } else {
+        seeds->ready = seeds->edge_count;
+    }
+    STAT_LEAVE();
+    
+    STAT_ENTER(MWCP_PHASE_CANDIDATES);
+    seeds->candidates = (CliqueCandidate*)buffer_reserve(seeds->candidates, &seeds->candidate_bytes,
+                                                         (size_t)n * sizeof(CliqueCandidate));
+    seeds->candidate_members = (int*)buffer_reserve(seeds->candidate_members, &seeds->member_bytes,
+                                                    (size_t)n * per_root * sizeof(int));
+    seeds->search = (CliqueSearch*)buffer_reserve(seeds->search, &seeds->search_bytes, sizeof(CliqueSearch));
+    CliqueSearch* cs = seeds->search;
+    if (k >= 2 && seeds->candidates && seeds->candidate_members && cs) {
+        int used = 0;
+        for (int root = 0; root < n && !(budget && budget_check_now(budget)); root++) {
+            long long weight;
+            int* members = seeds->candidate_members + used;
+            int size = best_clique_for_root(g, k, root, cs, members, &weight);
+            if (size < 2) continue;
+            CliqueCandidate* cand = &seeds->candidates[seeds->candidate_count++];
+            cand->weight = weight;
+            cand->size = size;
+            cand->first = used;
+            used += size;
+        }
+        qsort(seeds->candidates, (size_t)seeds->candidate_count, sizeof(CliqueCandidate), compare_candidates);
+    } else if (!seeds->keep) {
+        free(seeds->candidates);
+        free(seeds->candidate_members);
+        seeds->candidates = NULL;
+        seeds->candidate_members = NULL;
+        seeds->candidate_bytes = 0;
+        seeds->member_bytes = 0;
+    }
+    if (!seeds->keep) {
+        free(seeds->search);
+        seeds->search = NULL;
+        seeds->search_bytes = 0;
+    }
+    STAT_LEAVE();
+}
+
+static void seed_set_build(SeedSet* seeds, const Graph* g, int k, int mode, Budget* budget) {
+    memset(seeds, 0, sizeof(SeedSet));
+    seeds->threads = hardware_threads();
+    seed_set_rebuild(seeds, g, k, mode, budget);
+}
+
+static long long gcd_ll(long long a, long long b) {
+    while (b) {
+        long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/*
+ * Grow clique c greedily. The candidates are the unassigned common
+ * neighbours of its members, collected once from the shortest member row
+ * (a node qualifies when its gain entry for c counts every member) as a
+ * sorted list with their gain to c; each node that joins intersects the
+ * list with its own neighbours and adds its weight to the survivors' gains.
+ * Every round adds the candidate of largest gain (the lowest id on ties, a
+ * random one with an rng) while that gain is positive.
+ */
+static int expand_clique(WorkPartition* wp, int c) {
+    const Graph* g = wp->g;
+    int* cand = wp->cand;
+    long long* gain = wp->cand_gain;
+    int count = 0;
+    if (wp->size[c] == 0 || wp->size[c] >= wp->k) return 1;
+    
+    int pivot = wp->members[c][0];
+    for (int i = 1; i < wp->size[c]; i++) {
+        if (graph_degree(g, wp->members[c][i]) < graph_degree(g, pivot)) pivot = wp->members[c][i];
+    }
+    NeighbourIter it;
+    int v, w;
+    neighbour_iter_init(&it, g, pivot, 0);
+    while (neighbour_iter_next(&it, &v, &w)) {
+        if (wp->clique_of[v] >= 0) continue;
+        const GainEntry* e = gain_lookup(&wp->gains, v, c);
+        if (e == NULL || e->count != wp->size[c]) continue;
+        cand[count] = v;
+        gain[count++] = e->sum;
+    }
+    
+    while (wp->size[c] < wp->k) {
+        int best = -1;
+        int ties = 0;
+        for (int i = 0; i < count; i++) {
+            if (gain[i] <= 0) continue;
+            if (best < 0 || gain[i] > gain[best]) {
+                best = i;
+                ties = 1;
+            } else if (gain[i] == gain[best]) {
+                // The list is ascending, so the first keeps the lowest id
+                ties++;
+                if (wp->rng && rng_below(wp->rng, ties) == 0) best = i;
+            }
+        }
+        if (best < 0) break;
+        
+        v = cand[best];
+        if (!work_add(wp, v, c)) return 0;
+        int kept = 0;
+        if (g->layout == GRAPH_SPARSE) {
+            // Both lists are sorted: merge the candidates with v's row
+            size_t e = g->nbr_start[v], end = g->nbr_start[v + 1];
+            for (int i = 0; i < count && e < end; i++) {
+                int x = cand[i];
+                while (e < end && g->nbr[e] < x) e++;
+                if (e == end || g->nbr[e] != x) continue;
+                cand[kept] = x;
+                gain[kept++] = gain[i] + g->nbr_w[e];
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                int x = cand[i];
+                if (x == v || !adjacency_test(&g->adj, v, x)) continue;
+                cand[kept] = x;
+                gain[kept++] = gain[i] + graph_weight(g, v, x);
+            }
+        }
+        count = kept;
+    }
+    return 1;
+}
+
+/*
+ * Phase 1: place the heaviest enumerated candidate cliques whose members
+ * are all still free, then seed further cliques from the heaviest edges;
+ * every placed clique is expanded with unassigned common neighbours that
+ * bring positive weight
+ */
+static int phase_seed_cliques(WorkPartition* wp, SeedSet* seeds) {
+    int n = wp->n;
+    for (int i = 0; i < seeds->candidate_count; i++) {
+        if (wp->budget && budget_expired(wp->budget)) return 1;
+        const CliqueCandidate* cand = &seeds->candidates[i];
+        const int* members = seeds->candidate_members + cand->first;
+        int free_nodes = 1;
+        for (int j = 0; j < cand->size && free_nodes; j++) {
+            free_nodes = wp->clique_of[members[j]] < 0;
+        }
+        if (!free_nodes) continue;
+        
+        int c = work_new_clique(wp);
+        for (int j = 0; j < cand->size; j++) {
+            if (!work_add(wp, members[j], c)) return 0;
+        }
+        if (!expand_clique(wp, c)) return 0;
+    }
+    
+    // Once fewer than two nodes are free no edge can seed, so stop reading;
+    // with k = 1 no edge fits in a clique at all
+    const Edge* edges = seeds->edges;
+    long long run_start = 0, run_len = 1, run_offset = 0, run_step = 1;
+    for (long long e = 0; wp->k > 1 && wp->assigned < n - 1 && seed_edges_reach(seeds, e); e++) {
+        if (wp->budget && budget_expired(wp->budget)) return 1;
+        long long idx = e;
+        if (wp->rng) {
+            // Visit each run of equal weights in a seeded pseudo-random order;
+            // a run never crosses a lazy bucket, so it is already sorted
+            if (e == run_start + run_len || e == 0) {
+                run_start = e;
+                run_len = 1;
+                while (e + run_len < seeds->ready && edges[e + run_len].weight == edges[e].weight) run_len++;
+                run_offset = (long long)(rng_next(wp->rng) % (uint64_t)run_len);
+                run_step = 1 + (long long)(rng_next(wp->rng) % (uint64_t)run_len);
+                while (gcd_ll(run_step, run_len) != 1) run_step++;
+            }
+            idx = run_start + (run_offset + (e - run_start) * run_step) % run_len;
+        }
+        int u = edges[idx].u;
+        int v = edges[idx].v;
+        if (wp->clique_of[u] >= 0 || wp->clique_of[v] >= 0) continue;
+        
+        int c = work_new_clique(wp);
+        if (!work_add(wp, u, c) || !work_add(wp, v, c)) return 0;
+        if (!expand_clique(wp, c)) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Phase 2: put each remaining node into the feasible clique it gains the
+ * most from, or into a new singleton clique
+ */
+static int phase_assign_remaining(WorkPartition* wp) {
+    for (int t = 0; t < wp->n; t++) {
+        if (wp->budget && budget_expired(wp->budget)) return 1;
+        int node = wp->order[t];
+        if (wp->clique_of[node] >= 0) continue;
+        
+        int best_clique = -1;
+        int ties = 0;
+        long long best_gain = MIN_WEIGHT;
+        const GainRow* row = &wp->gains.rows[node];
+        for (int i = 0; i < row->cap; i++) {
+            const GainEntry* e = &row->slots[i];
+            int c = e->clique;
+            if (c < 0 || wp->size[c] >= wp->k || e->count != wp->size[c]) continue;
+            if (e->sum > best_gain) {
+                best_gain = e->sum;
+                best_clique = c;
+                ties = 1;
+            } else if (e->sum == best_gain) {
+                // Lowest id wins, or a uniformly random tie with an rng
+                ties++;
+                if (wp->rng ? rng_below(wp->rng, ties) == 0 : c < best_clique) best_clique = c;
+            }
+        }
+        
+        if (best_clique < 0) best_clique = work_new_clique(wp);
+        if (best_clique < 0 || !work_add(wp, node, best_clique)) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Phase 3: merge pairs of cliques whose union is a clique of positive gain,
+ * largest gain first. Clique-level sums live in a GainTable indexed by
+ * clique: entry (a, b) holds the number of edges between a and b and their
+ * total weight, so the union is a clique iff count == size[a] * size[b],
+ * and the gain of merging is the sum. Candidates wait in a max-heap; a
+ * merge bumps the version of both cliques, which lazily invalidates their
+ * queued pairs, and pushes fresh pairs for the merged clique only. Each
+ * merge costs O(log P + pairs touching the two cliques).
+ */
+typedef struct {
+    long long gain;
+    int a, b;                   // a < b
+    int version_a, version_b;
+} MergeCandidate;
+
+typedef struct {
+    MergeCandidate* items;
+    int size, cap;
+} MergeHeap;
+
+// Larger gain first, then lower ids, so the merge order is deterministic
+static inline int merge_before(const MergeCandidate* x, const MergeCandidate* y) {
+    if (x->gain != y->gain) return x->gain > y->gain;
+    if (x->a != y->a) return x->a < y->a;
+    return x->b < y->b;
+}
+
+static int merge_heap_push(MergeHeap* h, const MergeCandidate* c) {
+    if (h->size == h->cap) {
+        int cap = h->cap ? h->cap * 2 : 64;
+        MergeCandidate* items = (MergeCandidate*)mwcp_realloc(h->items, (size_t)cap * sizeof(MergeCandidate));
+        if (!items) return 0;
+        h->items = items;
+        h->cap = cap;
+    }
+    int pos = h->size++;
+    while (pos > 0 && merge_before(c, &h->items[(pos - 1) / 2])) {
+        h->items[pos] = h->items[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    h->items[pos] = *c;
+    return 1;
+}
+
+static MergeCandidate merge_heap_pop(MergeHeap* h) {
+    MergeCandidate top = h->items[0];
+    MergeCandidate last = h->items[--h->size];
+    int pos = 0;
+    for (;;) {
+        int child = 2 * pos + 1;
+        if (child >= h->size) break;
+        if (child + 1 < h->size && merge_before(&h->items[child + 1], &h->items[child])) child++;
+        if (!merge_before(&h->items[child], &last)) break;
+        h->items[pos] = h->items[child];
+        pos = child;
+    }
+    if (h->size > 0) h->items[pos] = last;
+    return top;
+}
+
+/*
+ * Phase 3 buffers, kept in the working partition so repeated merge phases
+ * (improvement rounds, restarts, batch solves) reuse them
+ */
+struct MergeScratch {
+    int* version;           // clique -> bumped by every merge it takes part in
+    MergeHeap heap;
+    GainTable pairs;        // clique-level edge counts and sums, rows cleared after use
+};
+
+static void merge_scratch_free(MergeScratch* m) {
+    if (!m) return;
+    free(m->version);
+    free(m->heap.items);
+    gain_table_free(&m->pairs);
+    free(m);
+}
+
+/*
+ * Queue every compatible, improving partner of clique a
+ */
+static int merge_push_partners(const WorkPartition* wp, const GainTable* pairs, MergeHeap* heap,
+                               const int* version, int a) {
+    const GainRow* row = &pairs->rows[a];
+    for (int i = 0; i < row->cap; i++) {
+        const GainEntry* e = &row->slots[i];
+        int b = e->clique;
+        if (b < 0 || e->sum <= 0 || wp->size[a] + wp->size[b] > wp->k) continue;
+        if (e->count != wp->size[a] * wp->size[b]) continue;
+        MergeCandidate c;
+        c.gain = e->sum;
+        c.a = a < b ? a : b;
+        c.b = a < b ? b : a;
+        c.version_a = version[c.a];
+        c.version_b = version[c.b];
+        if (!merge_heap_push(heap, &c)) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Move every member of clique t into s and fold t's clique-level sums into
+ * s's, keeping both directions of the pair table symmetric
+ */
+static int merge_cliques(WorkPartition* wp, GainTable* pairs, int s, int t) {
+    while (wp->size[t] > 0) {
+        int node = wp->members[t][wp->size[t] - 1];
+        work_remove(wp, node);
+        if (!work_add(wp, node, s)) return 0;
+    }
+    
+    GainRow* row = &pairs->rows[t];
+    for (int i = 0; i < row->cap; i++) {
+        GainEntry e = row->slots[i];
+        if (e.clique < 0) continue;
+        GainEntry* back = gain_lookup(pairs, e.clique, t);
+        gain_erase(pairs, e.clique, back);
+        if (e.clique == s) continue;
+        GainEntry* fwd = gain_upsert(pairs, s, e.clique);
+        back = fwd ? gain_upsert(pairs, e.clique, s) : NULL;
+        if (!back) return 0;
+        fwd->count += e.count;
+        fwd->sum += e.sum;
+        back->count += e.count;
+        back->sum += e.sum;
+    }
+    gain_row_clear(row);
+    return 1;
+}
+
+static int phase_merge_cliques(WorkPartition* wp) {
+    int n = wp->n;
+    MergeScratch* m = wp->merge;
+    if (m && m->pairs.capacity < n) {
+        merge_scratch_free(m);
+        wp->merge = m = NULL;
+    }
+    if (!m) {
+        m = (MergeScratch*)mwcp_calloc(1, sizeof(MergeScratch));
+        if (!m) return 0;
+        m->version = (int*)mwcp_malloc((size_t)n * sizeof(int));
+        if (!m->version || !gain_table_init(&m->pairs, wp->g)) {
+            merge_scratch_free(m);
+            return 0;
+        }
+        wp->merge = m;
+    }
+    m->pairs.g = wp->g;
+    m->heap.size = 0;
+    memset(m->version, 0, (size_t)n * sizeof(int));
+    GainTable* pairs = &m->pairs;
+    MergeHeap* heap = &m->heap;
+    int* version = m->version;
+    int ok = 1;
+    
+    // Edge counts and weights between cliques, each edge seen from both ends
+    for (int x = 0; ok && x < n; x++) {
+        int a = wp->clique_of[x];
+        if (a < 0) continue;
+        NeighbourIter it;
+        int y, w;
+        neighbour_iter_init(&it, wp->g, x, 0);
+        while (ok && neighbour_iter_next(&it, &y, &w)) {
+            int b = wp->clique_of[y];
+            if (b < 0 || b == a) continue;
+            GainEntry* e = gain_upsert(pairs, a, b);
+            ok = e != NULL;
+            if (ok) {
+                e->count++;
+                e->sum += w;
+            }
+        }
+    }
+    for (int a = 0; ok && a < wp->count; a++) {
+        ok = merge_push_partners(wp, pairs, heap, version, a);
+    }
+    
+    while (ok && heap->size > 0 && !(wp->budget && budget_expired(wp->budget))) {
+        MergeCandidate c = merge_heap_pop(heap);
+        STAT_ADD(merges_attempted, 1);
+        if (c.version_a != version[c.a] || c.version_b != version[c.b]) continue;
+        
+        // Fold the smaller clique into the larger (lower id on ties)
+        int s = c.a, t = c.b;
+        if (wp->size[t] > wp->size[s]) {
+            s = c.b;
+            t = c.a;
+        }
+        ok = merge_cliques(wp, pairs, s, t);
+        STAT_ADD(merges_accepted, 1);
+        version[s]++;
+        version[t]++;
+        ok = ok && merge_push_partners(wp, pairs, heap, version, s);
+    }
+    
+    for (int a = 0; a < wp->count; a++) {
+        gain_row_clear(&pairs->rows[a]);
+    }
+    return ok;
+}
+
+/*
+ * Phase 4: local search. Each pass visits every node and applies the best
+ * improving move among
+ *   - move:  v leaves its clique A for a clique B it is fully adjacent to
+ *   - swap:  v and u in B trade places (B full, or u is v's only non-neighbour)
+ *   - eject: v leaves A for a new singleton clique
+ * All moves keep every node in exactly one clique, so the denominator of the
+ * ratio objective is constant and a move raises the ratio exactly when it
+ * raises the total weight. Deltas come from the gain table in O(1) per
+ * candidate clique; passes repeat until no move improves or the budget ends.
+ */
+#ifndef LOCAL_SEARCH_MAX_PASSES
+#define LOCAL_SEARCH_MAX_PASSES 100
+#endif
+#ifndef LOCAL_SEARCH_TIME_LIMIT
+#define LOCAL_SEARCH_TIME_LIMIT 1.0     // seconds
+#endif
+
+#define MOVE_NONE 0
+#define MOVE_RELOCATE 1
+#define MOVE_SWAP 2
+#define MOVE_EJECT 3
+
+typedef struct {
+    int max_passes;         // <= 0 disables the phase
+    double time_limit;      // seconds, <= 0 for no limit
+} LocalSearchOptions;
+
+/*
+ * Whether a relocation (u = -1) or swap into clique b wins a tie with the
+ * current pick: lowest (target, partner) first, so the choice does not
+ * depend on the gain row's slot layout, which varies with a reused
+ * workspace's history. An ejection keeps its ties.
+ */
+static inline int move_tie_wins(int kind, int target, int partner, int b, int u) {
+    if (kind != MOVE_RELOCATE && kind != MOVE_SWAP) return 0;
+    return b < target || (b == target && u < partner);
+}
+
+/*
+ * Best improving move for node v; returns its weight delta (<= 0 if none)
+ */
+static long long best_move_for_node(const WorkPartition* wp, int v, int* kind, int* target, int* partner) {
+    const Graph* g = wp->g;
+    int a = wp->clique_of[v];
+    long long stay = work_gain(wp, v, a);
+    long long best = 0;
+    *kind = MOVE_NONE;
+    
+    if (wp->size[a] > 1 && -stay > best) {
+        best = -stay;
+        *kind = MOVE_EJECT;
+    }
+    
+    const GainRow* row = &wp->gains.rows[v];
+    for (int i = 0; i < row->cap; i++) {
+        const GainEntry* e = &row->slots[i];
+        int b = e->clique;
+        if (b < 0 || b == a) continue;
+        
+        if (e->count == wp->size[b] && wp->size[b] < wp->k) {
+            long long delta = e->sum - stay;
+            if (delta > best || (delta == best && move_tie_wins(*kind, *target, *partner, b, -1))) {
+                best = delta;
+                *kind = MOVE_RELOCATE;
+                *target = b;
+                *partner = -1;
+            }
+            continue;
+        }
+        if (e->count < wp->size[b] - 1) continue;
+        
+        // Swap: v replaces some u in b, u takes v's place in a
+        for (int j = 0; j < wp->size[b]; j++) {
+            int u = wp->members[b][j];
+            int adj_uv = graph_adjacent(g, u, v);
+            if (e->count - adj_uv != wp->size[b] - 1) continue;
+            const GainEntry* ua = gain_lookup(&wp->gains, u, a);
+            int fit_u = (ua ? ua->count : 0) - adj_uv;
+            if (fit_u != wp->size[a] - 1) continue;
+            
+            long long w_uv = adj_uv ? graph_weight(g, u, v) : 0;
+            long long delta = (e->sum - w_uv) + ((ua ? ua->sum : 0) - w_uv)
+                            - stay - work_gain(wp, u, b);
+            if (delta > best || (delta == best && move_tie_wins(*kind, *target, *partner, b, u))) {
+                best = delta;
+                *kind = MOVE_SWAP;
+                *target = b;
+                *partner = u;
+            }
+        }
+    }
+    return best;
+}
+
+/*
+ * Carry out a move returned by best_move_for_node
+ */
+static int work_apply_move(WorkPartition* wp, int v, int kind, int target, int partner) {
+    int a = wp->clique_of[v];
+    work_remove(wp, v);
+    if (kind == MOVE_EJECT) {
+        target = work_new_clique(wp);
+    } else if (kind == MOVE_SWAP) {
+        work_remove(wp, partner);
+        if (!work_add(wp, partner, a)) return 0;
+    }
+    return work_add(wp, v, target);
+}
+
+static int phase_local_search(WorkPartition* wp, const LocalSearchOptions* opt) {
+    double deadline = opt->time_limit > 0 ? clock_seconds() + opt->time_limit : 0;
+    
+    for (int pass = 0; pass < opt->max_passes; pass++) {
+        int improved = 0;
+        for (int v = 0; v < wp->n; v++) {
+            if ((v & 255) == 0 && deadline > 0 && clock_seconds() > deadline) return 1;
+            if (wp->budget && budget_expired(wp->budget)) return 1;
+            
+            int kind, target = -1, partner = -1;
+            long long delta = best_move_for_node(wp, v, &kind, &target, &partner);
+            // Membership is unchanged by every move, so the ratio rises exactly when W does
+            if (kind == MOVE_NONE || delta <= 0) continue;
+            if (!work_apply_move(wp, v, kind, target, partner)) return 0;
+            improved = 1;
+        }
+        if (!improved) break;
+    }
+    return 1;
+}
+
+static long long work_total_weight(const WorkPartition* wp) {
+    long long total = 0;
+    for (int c = 0; c < wp->count; c++) {
+        total += wp->weight[c];
+    }
+    return total;
+}
+
+/*
+ * Improvement rounds: Phases 3 and 4 alternate from the current partition
+ * until a round no longer raises the total weight W, or IMPROVE_MAX_ROUNDS
+ * rounds have run. Merges and moves keep every node in exactly one clique,
+ * so N is constant and raising W is the same as raising W / N. A round
+ * helps because local search can open new merges and merges can open new
+ * moves.
+ */
+#ifndef IMPROVE_MAX_ROUNDS
+#define IMPROVE_MAX_ROUNDS 8
+#endif
+
+static int improve_rounds(WorkPartition* wp, const LocalSearchOptions* opt) {
+    double start = clock_seconds();
+    long long weight = work_total_weight(wp);
+    
+    for (int round = 0; round < IMPROVE_MAX_ROUNDS; round++) {
+        if (wp->budget && budget_expired(wp->budget)) break;
+        LocalSearchOptions budget = *opt;
+        if (opt->time_limit > 0) {
+            budget.time_limit = opt->time_limit - (clock_seconds() - start);
+            if (budget.time_limit <= 0) break;
+        }
+        STAT_ENTER(MWCP_PHASE_MERGE);
+        int ok = phase_merge_cliques(wp);
+        STAT_LEAVE();
+        STAT_ENTER(MWCP_PHASE_LOCAL_SEARCH);
+        ok = ok && phase_local_search(wp, &budget);
+        STAT_LEAVE();
+        if (!ok) return 0;
+        
+        long long next = work_total_weight(wp);
+        if (next <= weight) break;
+        weight = next;
+    }
+    return 1;
+}
+
+/*
+ * Contiguous output partition: clique c is members[offsets[c]] ..
+ * members[offsets[c + 1] - 1]. It takes two heap blocks whatever the
+ * clique count; release it with freePartitionArena.
+ */
+typedef struct {
+    int count;              // number of cliques
+    int* offsets;           // count + 1 entries
+    int* members;           // offsets[count] == n entries
+} PartitionArena;
+
+void freePartitionArena(PartitionArena* arena) {
+    if (arena == NULL) return;
+    free(arena->offsets);
+    free(arena->members);
+    arena->count = 0;
+    arena->offsets = NULL;
+    arena->members = NULL;
+}
+
+static int arena_alloc(PartitionArena* arena, int n) {
+    arena->count = 0;
+    arena->offsets = (int*)mwcp_malloc(((size_t)n + 1) * sizeof(int));
+    arena->members = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    if (!arena->offsets || !arena->members) {
+        freePartitionArena(arena);
+        return 0;
+    }
+    arena->offsets[0] = 0;
+    return 1;
+}
+
+/*
+ * Copy the live cliques of the working partition, in id order
+ */
+static int work_partition_export(const WorkPartition* wp, PartitionArena* arena) {
+    STAT_ENTER(MWCP_PHASE_EXPORT);
+    if (!arena_alloc(arena, wp->n)) {
+        STAT_LEAVE();
+        return 0;
+    }
+    int filled = 0;
+    for (int c = 0; c < wp->count; c++) {
+        if (wp->size[c] == 0) continue;
+        memcpy(arena->members + filled, wp->members[c], (size_t)wp->size[c] * sizeof(int));
+        filled += wp->size[c];
+        arena->offsets[++arena->count] = filled;
+    }
+    STAT_LEAVE();
+    return 1;
+}
+
+/*
+ * Build the classic int** result (one block per clique) from an arena.
+ * The arena is released either way.
+ */
+static int** arena_to_jagged(PartitionArena* arena, int* partition_size, int** clique_sizes) {
+    STAT_ENTER(MWCP_PHASE_EXPORT);
+    int count = arena->count;
+    int** partition = (int**)mwcp_calloc((size_t)(count > 0 ? count : 1), sizeof(int*));
+    *clique_sizes = (int*)mwcp_calloc((size_t)(count > 0 ? count : 1), sizeof(int));
+    *partition_size = 0;
+    int ok = partition && *clique_sizes;
+    for (int c = 0; ok && c < count; c++) {
+        int size = arena->offsets[c + 1] - arena->offsets[c];
+        partition[c] = (int*)mwcp_malloc((size_t)size * sizeof(int));
+        ok = partition[c] != NULL;
+        if (ok) {
+            memcpy(partition[c], arena->members + arena->offsets[c], (size_t)size * sizeof(int));
+            (*clique_sizes)[c] = size;
+        }
+    }
+    if (!ok) {
+        for (int c = 0; partition && c < count; c++) free(partition[c]);
+        free(partition);
+        free(*clique_sizes);
+        *clique_sizes = NULL;
+        partition = NULL;
+    } else {
+        *partition_size = count;
+    }
+    freePartitionArena(arena);
+    STAT_LEAVE();
+    return partition;
+}
+
+/*
+ * Greedy Phases 1-2 on an empty working partition. With `complete` set
+ * Phase 2 ignores the budget, so every node ends up assigned even when
+ * seeding was cut short.
+ */
+static int run_greedy(WorkPartition* wp, SeedSet* seeds, int complete) {
+    STAT_ENTER(MWCP_PHASE_SEED);
+    int ok = phase_seed_cliques(wp, seeds);
+    STAT_LEAVE();
+    // Without edges (or edge memory) every node still gets assigned here
+    Budget* budget = wp->budget;
+    if (complete) wp->budget = NULL;
+    STAT_ENTER(MWCP_PHASE_ASSIGN);
+    ok = ok && phase_assign_remaining(wp);
+    STAT_LEAVE();
+    wp->budget = budget;
+    return ok;
+}
+
+/*
+ * Phases 1-4 on an empty working partition
+ */
+static int run_pipeline(WorkPartition* wp, SeedSet* seeds, const LocalSearchOptions* ls) {
+    if (!run_greedy(wp, seeds, 1)) return 0;
+    // Phases 3 and 4, repeated while they still raise the weight
+    return improve_rounds(wp, ls);
+}
+
+/*
+ * Group nodes by label (labels in 0..n-1): cliques in label order, members
+ * ascending
+ */
+static int export_labels(const int* labels, int n, PartitionArena* arena) {
+    STAT_ENTER(MWCP_PHASE_EXPORT);
+    int* first = (int*)mwcp_calloc((size_t)n + 1, sizeof(int));
+    if (!first || !arena_alloc(arena, n)) {
+        free(first);
+        STAT_LEAVE();
+        return 0;
+    }
+    
+    // Counting sort: first[label] becomes the next free slot of that label
+    for (int v = 0; v < n; v++) first[labels[v] + 1]++;
+    for (int c = 0; c < n; c++) {
+        if (first[c + 1] > 0) {
+            arena->offsets[arena->count + 1] = arena->offsets[arena->count] + first[c + 1];
+            arena->count++;
+        }
+        first[c + 1] += first[c];
+    }
+    for (int v = 0; v < n; v++) {
+        arena->members[first[labels[v]]++] = v;
+    }
+    free(first);
+    STAT_LEAVE();
+    return 1;
+}
+
+static int single_node_arena(PartitionArena* arena) {
+    if (!arena_alloc(arena, 1)) return 0;
+    arena->members[0] = 0;
+    arena->offsets[1] = 1;
+    arena->count = 1;
+    return 1;
+}
+
+static int** single_node_partition(int* partition_size, int** clique_sizes) {
+    PartitionArena arena;
+    return single_node_arena(&arena) ? arena_to_jagged(&arena, partition_size, clique_sizes) : NULL;
+}
+
+/*
+ * Per-thread solve state whose buffers only grow, so repeated solves reuse
+ * them: the graph store, working partition and seed set. Batch workers and
+ * component solves each own one; zero it before first use.
+ */
+typedef struct {
+    GraphStore store;
+    Graph g;                // borrows the store's buffers
+    WorkPartition wp;
+    SeedSet seeds;
+    int* rank;              // clique id -> output label
+    size_t rank_bytes;
+} SolveWorkspace;
+
+static void workspace_free(SolveWorkspace* ws) {
+    work_partition_free(&ws->wp);
+    seed_set_free(&ws->seeds);
+    graph_store_free(&ws->store);
+    free(ws->rank);
+    memset(ws, 0, sizeof(SolveWorkspace));
+}
+
+/*
+ * Run the pipeline on ws->g and write each node's clique into labels, live
+ * cliques numbered in id order as work_partition_export lists them. Returns
+ * the number of cliques, 0 if memory ran out.
+ */
+static int workspace_solve(SolveWorkspace* ws, int k, const LocalSearchOptions* ls, int* labels) {
+    int n = ws->g.n;
+    if (!work_partition_prepare(&ws->wp, &ws->g, k)) return 0;
+    seed_set_rebuild(&ws->seeds, &ws->g, k, SEED_EDGES_LAZY, NULL);
+    ws->rank = (int*)buffer_reserve(ws->rank, &ws->rank_bytes, (size_t)n * sizeof(int));
+    if (!ws->rank || !run_pipeline(&ws->wp, &ws->seeds, ls)) return 0;
+    
+    STAT_ENTER(MWCP_PHASE_EXPORT);
+    const WorkPartition* wp = &ws->wp;
+    int cliques = 0;
+    for (int c = 0; c < wp->count; c++) {
+        ws->rank[c] = wp->size[c] > 0 ? cliques++ : -1;
+    }
+    for (int v = 0; v < n; v++) {
+        labels[v] = ws->rank[wp->clique_of[v]];
+    }
+    STAT_LEAVE();
+    return cliques;
+}
+
+/*
+ * Work items ordered by size, largest first
+ */
+typedef struct {
+    int n;
+    int index;
+} SizeOrder;
+
+static int compare_size_order(const void* a, const void* b) {
+    const SizeOrder* x = (const SizeOrder*)a;
+    const SizeOrder* y = (const SizeOrder*)b;
+    if (x->n != y->n) return x->n > y->n ? -1 : 1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/*
+ * Reduction pre-pass. The objective is W / n and n is fixed, so it is
+ * maximized by maximizing W, which is the sum of what each connected
+ * component contributes: components are solved independently and their
+ * cliques combined, with nothing to coordinate between them. Before the
+ * split, every node without a positive incident weight (isolated nodes
+ * included) is fixed as a singleton; taking such a node out of any clique
+ * never lowers W, and dropping its edges can split components further. A
+ * component that already is a clique of size <= k without negative edges
+ * is optimal as one clique. The remaining components are solved on induced
+ * subgraphs, largest first from a shared cursor, one workspace per thread.
+ *
+ * Twin nodes are not contracted: under the size cap two twins may belong
+ * in different cliques (k = 2, twins u and v each with a heavy edge to x
+ * and to y), and the pipeline has no node multiplicities to solve a
+ * contracted graph with.
+ */
+typedef struct {
+    int count;              // components
+    int forced;             // nodes fixed as singletons
+    int* comp;              // node -> component, -1 for a fixed singleton
+    int* order;             // nodes grouped by component, ascending inside each
+    int* start;             // component c is order[start[c] .. start[c + 1])
+    int* local;             // node -> index inside its component
+    char* whole;            // component c is optimal as a single clique
+    int* labels;            // per order slot: clique inside the component
+    int* cliques;           // per component: number of cliques
+} Reduction;
+
+static void reduction_free(Reduction* r) {
+    free(r->comp);
+    free(r->order);
+    free(r->start);
+    free(r->local);
+    free(r->whole);
+    free(r->labels);
+    free(r->cliques);
+    memset(r, 0, sizeof(Reduction));
+}
+
+/*
+ * Fix singletons and find the components of the rest in O(n + m) (plus the
+ * bitset scans of the dense layouts). Returns 0 if memory runs out.
+ */
+static int graph_reduce(const Graph* g, int k, Reduction* r) {
+    int n = g->n;
+    memset(r, 0, sizeof(Reduction));
+    r->comp = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    r->order = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    r->start = (int*)mwcp_calloc((size_t)n + 1, sizeof(int));
+    r->local = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    r->whole = (char*)mwcp_malloc((size_t)n * sizeof(char));
+    r->labels = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    r->cliques = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    if (!r->comp || !r->order || !r->start || !r->local || !r->whole || !r->labels || !r->cliques) {
+        reduction_free(r);
+        return 0;
+    }
+    
+    // -2 marks a node still to be visited
+    for (int v = 0; v < n; v++) {
+        int positive = 0;
+        if (k > 1) {
+            NeighbourIter it;
+            int u, w;
+            neighbour_iter_init(&it, g, v, 0);
+            while (!positive && neighbour_iter_next(&it, &u, &w)) positive = w > 0;
+        }
+        r->comp[v] = positive ? -2 : -1;
+        if (!positive) r->forced++;
+    }
+    
+    // Breadth-first search; labels serves as the queue for all components
+    int* queue = r->labels;
+    int head = 0, tail = 0;
+    for (int s = 0; s < n; s++) {
+        if (r->comp[s] != -2) continue;
+        int c = r->count++;
+        int size = 0, negative = 0;
+        long long arcs = 0;
+        r->comp[s] = c;
+        queue[tail++] = s;
+        while (head < tail) {
+            int x = queue[head++];
+            NeighbourIter it;
+            int y, w;
+            size++;
+            neighbour_iter_init(&it, g, x, 0);
+            while (neighbour_iter_next(&it, &y, &w)) {
+                if (r->comp[y] == -1) continue;
+                arcs++;
+                negative |= w < 0;
+                if (r->comp[y] == -2) {
+                    r->comp[y] = c;
+                    queue[tail++] = y;
+                }
+            }
+        }
+        r->whole[c] = size <= k && !negative && arcs == (long long)size * (size - 1);
+        r->start[c + 1] = size;
+    }
+    
+    // Counting sort by component keeps each group ascending
+    for (int c = 0; c < r->count; c++) {
+        r->start[c + 1] += r->start[c];
+        r->cliques[c] = r->start[c];
+    }
+    for (int v = 0; v < n; v++) {
+        int c = r->comp[v];
+        if (c < 0) continue;
+        int slot = r->cliques[c]++;
+        r->order[slot] = v;
+        r->local[v] = slot - r->start[c];
+    }
+    return 1;
+}
+
+/*
+ * Subgraph induced by one component, nodes renumbered by r->local, built
+ * from `store` in the layout graph_build would pick for it
+ */
+static int graph_induced(Graph* sub, const Graph* g, const Reduction* r, int c, GraphStore* store) {
+    const int* nodes = r->order + r->start[c];
+    int count = r->start[c + 1] - r->start[c];
+    size_t* degree = (size_t*)graph_take(store, GRAPH_STORE_DEGREE, ((size_t)count + 1) * sizeof(size_t), 1);
+    if (!degree) return 0;
+    long long edges = 0;
+    for (int i = 0; i < count; i++) {
+        NeighbourIter it;
+        int v, w;
+        neighbour_iter_init(&it, g, nodes[i], nodes[i] + 1);
+        while (neighbour_iter_next(&it, &v, &w)) {
+            if (r->comp[v] < 0) continue;
+            degree[i]++;
+            degree[r->local[v]]++;
+            edges++;
+        }
+    }
+    
+    // Groups are ascending, so local ids keep the original neighbour order
+    if (graph_is_sparse(count, edges)) {
+        if (!graph_alloc_sparse_from(sub, count, degree, store)) return 0;
+        for (int i = 0; i < count; i++) {
+            NeighbourIter it;
+            int v, w;
+            neighbour_iter_init(&it, g, nodes[i], nodes[i] + 1);
+            while (neighbour_iter_next(&it, &v, &w)) {
+                if (r->comp[v] >= 0) graph_sparse_append(sub, degree, i, r->local[v], w);
+            }
+        }
+        return 1;
+    }
+    if (!graph_alloc_from(sub, count, store)) return 0;
+    for (int i = 0; i < count; i++) {
+        int* dst = graph_upper_row(sub, i);
+        for (int j = 0; j < count - 1 - i; j++) {
+            dst[j] = NO_EDGE;
+        }
+        NeighbourIter it;
+        int v, w;
+        neighbour_iter_init(&it, g, nodes[i], nodes[i] + 1);
+        while (neighbour_iter_next(&it, &v, &w)) {
+            if (r->comp[v] >= 0) dst[r->local[v] - i - 1] = w;
+        }
+        graph_finish_row(sub, i, 0);
+    }
+    return 1;
+}
+
+typedef struct {
+    const Graph* g;
+    int k;
+    Reduction* r;
+    const SizeOrder* queue;     // components for the pipeline, largest first
+    int queued;
+    int next;                   // next queue slot to hand out
+    int seed_threads;           // per workspace
+    double deadline;            // local search stops here for every component, 0 for none
+    int failed;
+} ComponentJob;
+
+typedef struct {
+    ComponentJob* job;
+    SolveWorkspace ws;
+} ComponentWorker;
+
+static void* component_worker_main(void* arg) {
+    ComponentWorker* self = (ComponentWorker*)arg;
+    ComponentJob* job = self->job;
+    Reduction* r = job->r;
+    SolveWorkspace* ws = &self->ws;
+    ws->seeds.threads = job->seed_threads;
+    ws->seeds.keep = 1;
+    LocalSearchOptions ls;
+    for (;;) {
+        int slot = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED);
+        if (slot >= job->queued || __atomic_load_n(&job->failed, __ATOMIC_RELAXED)) break;
+        // Components share the whole solve's local-search time; once it is
+        // spent, the rest still get their greedy phases and merges
+        ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+        ls.time_limit = 0;
+        if (job->deadline > 0) {
+            ls.time_limit = job->deadline - clock_seconds();
+            if (ls.time_limit <= 0) ls.max_passes = 0;
+        }
+        int c = job->queue[slot].index;
+        // The pipeline expects k <= n
+        int k = job->k < job->queue[slot].n ? job->k : job->queue[slot].n;
+        int cliques = graph_induced(&ws->g, job->g, r, c, &ws->store) ?
+                      workspace_solve(ws, k, &ls, r->labels + r->start[c]) : 0;
+        r->cliques[c] = cliques;
+        if (!cliques) __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    }
+    workspace_free(ws);
+    return NULL;
+}
+
+/*
+ * Solve the components of a reduction and combine them: cliques of each
+ * component in discovery order, then the fixed singletons
+ */
+static int solve_components(const Graph* g, int k, Reduction* r, PartitionArena* arena) {
+    int n = g->n;
+    ComponentJob job;
+    memset(&job, 0, sizeof(ComponentJob));
+    job.g = g;
+    job.k = k;
+    job.r = r;
+    job.deadline = LOCAL_SEARCH_TIME_LIMIT > 0 ? clock_seconds() + LOCAL_SEARCH_TIME_LIMIT : 0;
+    SizeOrder* queue = (SizeOrder*)mwcp_malloc(((size_t)r->count + 1) * sizeof(SizeOrder));
+    int* labels = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int ok = queue != NULL && labels != NULL;
+    
+    for (int c = 0; ok && c < r->count; c++) {
+        if (r->whole[c]) continue;
+        queue[job.queued].n = r->start[c + 1] - r->start[c];
+        queue[job.queued++].index = c;
+    }
+    if (ok && job.queued > 0) {
+        if (job.queued > 1) qsort(queue, (size_t)job.queued, sizeof(SizeOrder), compare_size_order);
+        job.queue = queue;
+        int threads = hardware_threads();
+        int workers = threads < job.queued ? threads : job.queued;
+        // A lone worker keeps the parallel edge collection and sort
+        job.seed_threads = workers == 1 ? threads : 1;
+        ComponentWorker* records = (ComponentWorker*)mwcp_calloc((size_t)workers, sizeof(ComponentWorker));
+        ok = records != NULL;
+        for (int t = 0; ok && t < workers; t++) {
+            records[t].job = &job;
+        }
+        if (ok) run_workers(component_worker_main, records, sizeof(ComponentWorker), workers);
+        ok = ok && !job.failed;
+        free(records);
+    }
+    
+    int next = 0;
+    for (int c = 0; ok && c < r->count; c++) {
+        for (int i = r->start[c]; i < r->start[c + 1]; i++) {
+            labels[r->order[i]] = next + (r->whole[c] ? 0 : r->labels[i]);
+        }
+        next += r->whole[c] ? 1 : r->cliques[c];
+    }
+    for (int v = 0; ok && v < n; v++) {
+        if (r->comp[v] < 0) labels[v] = next++;
+    }
+    ok = ok && export_labels(labels, n, arena);
+    free(queue);
+    free(labels);
+    return ok;
+}
+
+/*
+ * Heuristic pipeline on an already built graph (n >= 2, 1 <= k <= n). When
+ * the reduction leaves the graph whole, it runs on g directly.
+ */
+static int solve_graph(const Graph* g, int k, PartitionArena* arena) {
+    Reduction r;
+    STAT_ENTER(MWCP_PHASE_REDUCE);
+    int reduced = graph_reduce(g, k, &r);
+    STAT_LEAVE();
+    if (reduced && (r.forced > 0 || r.count != 1 || r.whole[0])) {
+        int ok = solve_components(g, k, &r, arena);
+        reduction_free(&r);
+        return ok;
+    }
+    if (reduced) reduction_free(&r);
+    
+    WorkPartition wp;
+    if (!work_partition_init(&wp, g, k)) return 0;
+    
+    // Edges in weight order (finished lazily) and candidate cliques for Phase 1
+    SeedSet seeds;
+    seed_set_build(&seeds, g, k, SEED_EDGES_LAZY, NULL);
+    
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = LOCAL_SEARCH_TIME_LIMIT;
+    int ok = run_pipeline(&wp, &seeds, &ls);
+    seed_set_free(&seeds);
+    
+    ok = ok && work_partition_export(&wp, arena);
+    work_partition_free(&wp);
+    return ok;
+}
+
+/*
+ * Main clique partition function, arena output: returns 1 and fills
+ * *arena on success, 0 on invalid input or allocation failure
+ */
+int maxWeightCliquePartitionArena(int** weights, int n, int k, PartitionArena* arena) {
+    // Input validation
+    if (n <= 0 || k <= 0 || k > n || arena == NULL) return 0;
+    
+    // Handle single node case
+    if (n == 1) return single_node_arena(arena);
+    
+    // Internal graph copy
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return 0;
+    int ok = solve_graph(&g, k, arena);
+    graph_free(&g);
+    
+    return ok;
+}
+
+/*
+ * Main clique partition function
+ */
+int** maxWeightCliquePartition(int** weights, int n, int k, int* partition_size, int** clique_sizes) {
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    
+    // Initialize output
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    
+    PartitionArena arena;
+    if (!maxWeightCliquePartitionArena(weights, n, k, &arena)) return NULL;
+    return arena_to_jagged(&arena, partition_size, clique_sizes);
+}
+
+/*
+ * Node reordering. Input ids carry no locality, so a clique's members and a
+ * node's neighbours are scattered over the weight rows, the adjacency
+ * bitset and the gain tables. An optional relabeling pass permutes the
+ * nodes first, the solver runs on the permuted copy, and the partition is
+ * mapped back to the caller's ids:
+ *   degeneracy - smallest-last order, densest cores first (Matula-Beck
+ *                bucket queue, O(n + m))
+ *   rcm        - reverse Cuthill-McKee: breadth-first from a minimum-degree
+ *                node of each component, lower-degree neighbours first,
+ *                reversed; keeps neighbours close in id
+ *   community  - label propagation over positive weights, then nodes
+ *                grouped by community so likely clique mates are adjacent
+ */
+#define MWCP_ORDER_NONE 0
+#define MWCP_ORDER_DEGENERACY 1
+#define MWCP_ORDER_RCM 2
+#define MWCP_ORDER_COMMUNITY 3
+
+#ifndef ORDER_COMMUNITY_ROUNDS
+#define ORDER_COMMUNITY_ROUNDS 10
+#endif
+
+/*
+ * perm[new] = old, smallest-last: the node removed last comes first
+ */
+static int order_degeneracy(const Graph* g, int* perm) {
+    int n = g->n;
+    int* degree = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int* bin = (int*)mwcp_calloc((size_t)n + 1, sizeof(int));
+    int* pos = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int* vert = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int ok = degree && bin && pos && vert;
+    
+    for (int v = 0; ok && v < n; v++) {
+        degree[v] = graph_degree(g, v);
+        bin[degree[v]]++;
+    }
+    // bin[d] becomes the first slot of degree d in vert
+    for (int d = 0, start = 0; ok && d <= n; d++) {
+        int count = bin[d];
+        bin[d] = start;
+        start += count;
+    }
+    for (int v = 0; ok && v < n; v++) {
+        pos[v] = bin[degree[v]]++;
+        vert[pos[v]] = v;
+    }
+    for (int d = n; ok && d > 0; d--) bin[d] = bin[d - 1];
+    if (ok) bin[0] = 0;
+    
+    // Remove vert[i] in order; each later neighbour moves one bucket down
+    for (int i = 0; ok && i < n; i++) {
+        int v = vert[i];
+        NeighbourIter it;
+        int u, w;
+        neighbour_iter_init(&it, g, v, 0);
+        while (neighbour_iter_next(&it, &u, &w)) {
+            if (degree[u] <= degree[v]) continue;
+            int du = degree[u];
+            int first = vert[bin[du]];
+            if (first != u) {
+                vert[pos[u]] = first;
+                pos[first] = pos[u];
+                vert[bin[du]] = u;
+                pos[u] = bin[du];
+            }
+            bin[du]++;
+            degree[u]--;
+        }
+        perm[n - 1 - i] = v;
+    }
+    free(degree);
+    free(bin);
+    free(pos);
+    free(vert);
+    return ok;
+}
+
+/*
+ * perm[new] = old, reverse Cuthill-McKee over every component
+ */
+static int order_rcm(const Graph* g, int* perm) {
+    int n = g->n;
+    SizeOrder* by_degree = (SizeOrder*)mwcp_malloc((size_t)n * sizeof(SizeOrder));
+    SizeOrder* next = (SizeOrder*)mwcp_malloc((size_t)n * sizeof(SizeOrder));
+    char* seen = (char*)mwcp_calloc((size_t)n, sizeof(char));
+    int* queue = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int ok = by_degree && next && seen && queue;
+    
+    // Negated degrees: compare_size_order then sorts lowest degree first, ties by id
+    for (int v = 0; ok && v < n; v++) {
+        by_degree[v].n = -graph_degree(g, v);
+        by_degree[v].index = v;
+    }
+    if (ok) qsort(by_degree, (size_t)n, sizeof(SizeOrder), compare_size_order);
+    int head = 0, tail = 0;
+    for (int s = 0; ok && s < n; s++) {
+        int root = by_degree[s].index;
+        if (seen[root]) continue;
+        seen[root] = 1;
+        queue[tail++] = root;
+        while (head < tail) {
+            int v = queue[head++];
+            int count = 0;
+            NeighbourIter it;
+            int u, w;
+            neighbour_iter_init(&it, g, v, 0);
+            while (neighbour_iter_next(&it, &u, &w)) {
+                if (seen[u]) continue;
+                seen[u] = 1;
+                next[count].n = -graph_degree(g, u);
+                next[count++].index = u;
+            }
+            if (count > 1) qsort(next, (size_t)count, sizeof(SizeOrder), compare_size_order);
+            for (int i = 0; i < count; i++) {
+                queue[tail++] = next[i].index;
+            }
+        }
+    }
+    for (int i = 0; ok && i < n; i++) {
+        perm[i] = queue[n - 1 - i];
+    }
+    free(by_degree);
+    free(next);
+    free(seen);
+    free(queue);
+    return ok;
+}
+
+/*
+ * perm[new] = old, grouped by label propagation communities: each node in
+ * turn takes the label with the largest positive weight among its
+ * neighbours (ties to the lowest label) until no label changes
+ */
+static int order_community(const Graph* g, int* perm) {
+    int n = g->n;
+    int* label = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    long long* score = (long long*)mwcp_calloc((size_t)n, sizeof(long long));
+    int* touched = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int* first = (int*)mwcp_calloc((size_t)n + 1, sizeof(int));
+    int ok = label && score && touched && first;
+    
+    for (int v = 0; ok && v < n; v++) label[v] = v;
+    for (int round = 0; ok && round < ORDER_COMMUNITY_ROUNDS; round++) {
+        int changed = 0;
+        for (int v = 0; v < n; v++) {
+            int count = 0;
+            NeighbourIter it;
+            int u, w;
+            neighbour_iter_init(&it, g, v, 0);
+            while (neighbour_iter_next(&it, &u, &w)) {
+                if (w <= 0) continue;
+                if (score[label[u]] == 0) touched[count++] = label[u];
+                score[label[u]] += w;
+            }
+            int best = label[v];
+            long long best_score = 0;
+            for (int i = 0; i < count; i++) {
+                int l = touched[i];
+                if (score[l] > best_score || (score[l] == best_score && l < best)) {
+                    best_score = score[l];
+                    best = l;
+                }
+                score[l] = 0;
+            }
+            if (best != label[v]) {
+                label[v] = best;
+                changed++;
+            }
+        }
+        if (!changed) break;
+    }
+    
+    // Counting sort by label; ascending ids inside each community
+    for (int v = 0; ok && v < n; v++) first[label[v] + 1]++;
+    for (int l = 0; ok && l < n; l++) first[l + 1] += first[l];
+    for (int v = 0; ok && v < n; v++) perm[first[label[v]]++] = v;
+    free(label);
+    free(score);
+    free(touched);
+    free(first);
+    return ok;
+}
+
+/*
+ * perm[new] = old for any MWCP_ORDER_* (the identity for none)
+ */
+static int node_order(const Graph* g, int order, int* perm) {
+    if (order == MWCP_ORDER_DEGENERACY) return order_degeneracy(g, perm);
+    if (order == MWCP_ORDER_RCM) return order_rcm(g, perm);
+    if (order == MWCP_ORDER_COMMUNITY) return order_community(g, perm);
+    for (int i = 0; i < g->n; i++) {
+        perm[i] = i;
+    }
+    return 1;
+}
+
+static int compare_edge_targets(const void* a, const void* b) {
+    const Edge* x = (const Edge*)a;
+    const Edge* y = (const Edge*)b;
+    return (x->v > y->v) - (x->v < y->v);
+}
+
+/*
+ * Copy of g with node perm[i] renamed i (inv is the inverse permutation),
+ * in the same layout family
+ */
+static int graph_permute(Graph* dst, const Graph* g, const int* perm, const int* inv) {
+    int n = g->n;
+    if (g->layout != GRAPH_SPARSE) {
+        if (!graph_alloc(dst, n)) return 0;
+        for (int u = 0; u < n; u++) {
+            int* row = graph_upper_row(dst, u);
+            for (int j = 0; j < n - 1 - u; j++) {
+                row[j] = NO_EDGE;
+            }
+            NeighbourIter it;
+            int x, w;
+            neighbour_iter_init(&it, g, perm[u], 0);
+            while (neighbour_iter_next(&it, &x, &w)) {
+                if (inv[x] > u) row[inv[x] - u - 1] = w;
+            }
+            graph_finish_row(dst, u, 0);
+        }
+        return 1;
+    }
+    
+    size_t* degree = (size_t*)mwcp_malloc(((size_t)n + 1) * sizeof(size_t));
+    int widest = 0;
+    for (int u = 0; degree && u < n; u++) {
+        degree[u] = (size_t)graph_degree(g, perm[u]);
+        if ((int)degree[u] > widest) widest = (int)degree[u];
+    }
+    Edge* row = degree ? (Edge*)mwcp_malloc(((size_t)widest + 1) * sizeof(Edge)) : NULL;
+    int ok = row != NULL && graph_alloc_sparse(dst, n, degree);
+    
+    // Each row is renamed and re-sorted on its own, both directions included
+    for (int u = 0; ok && u < n; u++) {
+        int count = 0;
+        NeighbourIter it;
+        int x, w;
+        neighbour_iter_init(&it, g, perm[u], 0);
+        while (neighbour_iter_next(&it, &x, &w)) {
+            row[count].u = u;
+            row[count].v = inv[x];
+            row[count++].weight = w;
+        }
+        if (count > 1) qsort(row, (size_t)count, sizeof(Edge), compare_edge_targets);
+        size_t at = dst->nbr_start[u];
+        for (int i = 0; i < count; i++) {
+            dst->nbr[at + i] = row[i].v;
+            dst->nbr_w[at + i] = row[i].weight;
+        }
+    }
+    free(degree);
+    free(row);
+    return ok;
+}
+
+/*
+ * solve_graph on a copy of g relabeled by `order`, with the partition
+ * mapped back to g's ids (cliques in the permuted solve's order, members
+ * ascending)
+ */
+static int solve_graph_ordered(const Graph* g, int k, int order, PartitionArena* arena) {
+    if (order == MWCP_ORDER_NONE) return solve_graph(g, k, arena);
+    int n = g->n;
+    int* perm = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int* inv = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    Graph permuted;
+    
+    STAT_ENTER(MWCP_PHASE_REORDER);
+    int ok = perm != NULL && inv != NULL && node_order(g, order, perm);
+    for (int i = 0; ok && i < n; i++) {
+        inv[perm[i]] = i;
+    }
+    int built = ok && graph_permute(&permuted, g, perm, inv);
+    STAT_LEAVE();
+    
+    ok = built && solve_graph(&permuted, k, arena);
+    if (built) graph_free(&permuted);
+    for (int i = 0; ok && i < n; i++) {
+        arena->members[i] = perm[arena->members[i]];
+    }
+    for (int c = 0; ok && c < arena->count; c++) {
+        int* members = arena->members + arena->offsets[c];
+        int size = arena->offsets[c + 1] - arena->offsets[c];
+        // Insertion sort: cliques are small
+        for (int i = 1; i < size; i++) {
+            int v = members[i];
+            int j = i;
+            while (j > 0 && members[j - 1] > v) {
+                members[j] = members[j - 1];
+                j--;
+            }
+            members[j] = v;
+        }
+    }
+    free(perm);
+    free(inv);
+    return ok;
+}
+
+/*
+ * maxWeightCliquePartitionArena with the nodes first relabeled by `order`
+ * (MWCP_ORDER_*) for cache locality. The partition uses the caller's ids.
+ */
+int maxWeightCliquePartitionArenaOrdered(int** weights, int n, int k, int order, PartitionArena* arena) {
+    if (n <= 0 || k <= 0 || k > n || arena == NULL) return 0;
+    if (order < MWCP_ORDER_NONE || order > MWCP_ORDER_COMMUNITY) return 0;
+    if (n == 1) return single_node_arena(arena);
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return 0;
+    int ok = solve_graph_ordered(&g, k, order, arena);
+    graph_free(&g);
+    return ok;
+}
+
+/*
+ * Attach stats to the calling thread, or detach with NULL. Every later solve
+ * on this thread adds to it, so zero it first for per-call figures. Has no
+ * effect unless built with MWCP_STATS.
+ */
+void maxWeightCliquePartitionStats(MwcpStats* stats) {
+#ifdef MWCP_STATS
+    memset(&stats_state, 0, sizeof(StatsState));
+    stats_state.sink = stats;
+#else
+    (void)stats;
+#endif
+}
+
+/*
+ * Short name of an MWCP_PHASE_* index, for reports
+ */
+const char* maxWeightCliquePartitionPhaseName(int phase) {
+    static const char* names[MWCP_PHASE_COUNT] = {
+        "graph", "collect", "sort", "candidates", "seed", "assign", "merge", "local_search", "export", "reduce",
+        "reorder"
+    };
+    return phase >= 0 && phase < MWCP_PHASE_COUNT ? names[phase] : "unknown";
+}
+
+/*
+ * Solve an instance stored as upper-triangular text (Problem.md format).
+ * The node count is inferred from the file and written to *n. Returns NULL
+ * if the file is unreadable or malformed, or if k > n.
+ */
+int** maxWeightCliquePartitionFromFile(const char* path, int k, int* n, int* partition_size, int** clique_sizes) {
+    if (path == NULL || n == NULL || k <= 0) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    *n = 0;
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_load_text(&g, path, hardware_threads());
+    STAT_LEAVE();
+    if (!built) return NULL;
+    *n = g.n;
+    
+    PartitionArena arena;
+    int ok = k <= g.n && (g.n == 1 ? single_node_arena(&arena) : solve_graph(&g, k, &arena));
+    graph_free(&g);
+    return ok ? arena_to_jagged(&arena, partition_size, clique_sizes) : NULL;
+}
+
+/*
+ * Convert an upper-triangular text file to the binary .mwcp format.
+ * Returns 1 on success, 0 if the input is malformed or the output cannot
+ * be written.
+ */
+int maxWeightCliquePartitionConvert(const char* text_path, const char* binary_path) {
+    if (text_path == NULL || binary_path == NULL) return 0;
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_load_text(&g, text_path, hardware_threads());
+    STAT_LEAVE();
+    if (!built) return 0;
+    int ok = graph_save_binary(&g, binary_path);
+    graph_free(&g);
+    return ok;
+}
+
+/*
+ * Solve an instance stored in the binary .mwcp format. Same contract as
+ * maxWeightCliquePartitionFromFile.
+ */
+int** maxWeightCliquePartitionFromBinary(const char* path, int k, int* n, int* partition_size, int** clique_sizes) {
+    if (path == NULL || n == NULL || k <= 0) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    *n = 0;
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_load_binary(&g, path);
+    STAT_LEAVE();
+    if (!built) return NULL;
+    *n = g.n;
+    
+    PartitionArena arena;
+    int ok = k <= g.n && (g.n == 1 ? single_node_arena(&arena) : solve_graph(&g, k, &arena));
+    graph_free(&g);
+    return ok ? arena_to_jagged(&arena, partition_size, clique_sizes) : NULL;
+}
+
+/*
+ * Multi-start options: `starts` runs of the pipeline spread over `threads`
+ * workers. Start 0 is the deterministic pipeline; start s > 0 shuffles the
+ * node order and breaks weight ties with an rng seeded from (seed, s). The
+ * reported partition is the best total weight, lowest start on ties, so the
+ * result depends only on seed and starts as long as time_limit is 0.
+ */
+typedef struct {
+    int starts;
+    int threads;
+    unsigned long long seed;
+    double time_limit;      // local search seconds per start, 0 = pass limit only
+} MultiStartOptions;
+
+typedef struct {
+    const Graph* g;
+    SeedSet* seeds;         // fully sorted, so solves only read it
+    int k;
+    const MultiStartOptions* options;
+    int first_start;        // this worker runs first_start, first_start + stride, ...
+    int stride;
+    int* best_labels;
+    long long best_weight;
+    int best_start;         // -1 until a start completes
+    int ok;
+} MultiStartWorker;
+
+static void* multistart_worker_main(void* arg) {
+    MultiStartWorker* worker = (MultiStartWorker*)arg;
+    const MultiStartOptions* opt = worker->options;
+    WorkPartition wp;
+    worker->ok = work_partition_init(&wp, worker->g, worker->k);
+    if (!worker->ok) return NULL;
+    
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = opt->time_limit;
+    
+    for (int start = worker->first_start; start < opt->starts; start += worker->stride) {
+        Rng rng;
+        rng_seed(&rng, (uint64_t)opt->seed ^ ((uint64_t)start * 0xD1B54A32D192ED03ULL));
+        work_partition_reset(&wp, start == 0 ? NULL : &rng);
+        if (!run_pipeline(&wp, worker->seeds, &ls)) {
+            worker->ok = 0;
+            break;
+        }
+        long long total = work_total_weight(&wp);
+        if (worker->best_start < 0 || total > worker->best_weight) {
+            worker->best_weight = total;
+            worker->best_start = start;
+            memcpy(worker->best_labels, wp.clique_of, (size_t)worker->g->n * sizeof(int));
+        }
+    }
+    work_partition_free(&wp);
+    return NULL;
+}
+
+/*
+ * Multi-start solve: same output contract as maxWeightCliquePartition
+ */
+int** maxWeightCliquePartitionMultiStart(int** weights, int n, int k, int* partition_size, int** clique_sizes,
+                                         const MultiStartOptions* options) {
+    if (n <= 0 || k <= 0 || k > n) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL || options == NULL) return NULL;
+    
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    if (n == 1) return single_node_partition(partition_size, clique_sizes);
+    
+    MultiStartOptions opt = *options;
+    if (opt.starts < 1) opt.starts = 1;
+    if (opt.threads < 1) opt.threads = hardware_threads();
+    if (opt.threads > opt.starts) opt.threads = opt.starts;
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return NULL;
+    SeedSet seeds;
+    seed_set_build(&seeds, &g, k, SEED_EDGES_SORTED, NULL);
+    
+    MultiStartWorker* workers = (MultiStartWorker*)mwcp_calloc((size_t)opt.threads, sizeof(MultiStartWorker));
+    int ok = workers != NULL;
+    for (int t = 0; ok && t < opt.threads; t++) {
+        workers[t].g = &g;
+        workers[t].seeds = &seeds;
+        workers[t].k = k;
+        workers[t].options = &opt;
+        workers[t].first_start = t;
+        workers[t].stride = opt.threads;
+        workers[t].best_start = -1;
+        workers[t].best_labels = (int*)mwcp_malloc((size_t)n * sizeof(int));
+        ok = workers[t].best_labels != NULL;
+    }
+    if (ok) run_workers(multistart_worker_main, workers, sizeof(MultiStartWorker), opt.threads);
+    
+    // Reduce: highest weight, then lowest start index
+    int best = -1;
+    for (int t = 0; ok && t < opt.threads; t++) {
+        if (!workers[t].ok) ok = 0;
+        else if (workers[t].best_start >= 0 &&
+                 (best < 0 || workers[t].best_weight > workers[best].best_weight ||
+                  (workers[t].best_weight == workers[best].best_weight &&
+                   workers[t].best_start < workers[best].best_start))) {
+            best = t;
+        }
+    }
+    
+    int** partition = NULL;
+    if (ok && best >= 0) {
+        PartitionArena arena;
+        if (export_labels(workers[best].best_labels, n, &arena)) {
+            partition = arena_to_jagged(&arena, partition_size, clique_sizes);
+        }
+    }
+    
+    for (int t = 0; workers && t < opt.threads; t++) {
+        free(workers[t].best_labels);
+    }
+    free(workers);
+    seed_set_free(&seeds);
+    graph_free(&g);
+    return partition;
+}
+
+/*
+ * Anytime solve for latency-bound callers. Candidate enumeration and
+ * seeding stop when the budget runs out, but the first run's Phase 2
+ * always completes, so a valid partition exists from then on; merge and
+ * local search then improve it, followed by randomized restarts as in
+ * multi-start, until the time limit passes, the cancel flag is set or
+ * max_starts runs are done. Interrupted improvement phases stop between
+ * moves, so every run leaves a valid partition; a restart cut short in its
+ * greedy phases is dropped. The limit covers the whole call; only the
+ * linear-time steps (graph construction, edge ordering, Phase 2) can
+ * overrun it.
+ */
+#define ANYTIME_COMPLETED 0         // max_starts runs finished
+#define ANYTIME_DEADLINE 1          // time limit reached
+#define ANYTIME_CANCELLED 2         // cancel flag seen
+
+typedef struct {
+    double time_limit;              // seconds for the whole call, <= 0 for none
+    const volatile int* cancel;     // another thread sets *cancel nonzero to stop; NULL for none
+    int max_starts;                 // runs, <= 0 for no cap (a single run without limit or flag)
+    unsigned long long seed;        // restart seed, as in MultiStartOptions
+} AnytimeOptions;
+
+typedef struct {
+    double objective;       // ratio of the returned partition
+    int starts;             // runs completed, the first included
+    int best_start;         // run that produced the partition; 0 is deterministic
+    int stopped;            // ANYTIME_*
+    double elapsed;         // seconds spent in the call
+} AnytimeResult;
+
+/*
+ * Anytime solve with the maxWeightCliquePartition output contract. options
+ * and result may be NULL (a single deterministic run).
+ */
+int** maxWeightCliquePartitionAnytime(int** weights, int n, int k, int* partition_size, int** clique_sizes,
+                                      const AnytimeOptions* options, AnytimeResult* result) {
+    if (n <= 0 || k <= 0 || k > n) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    
+    double started = clock_seconds();
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    if (result) memset(result, 0, sizeof(AnytimeResult));
+    if (n == 1) {
+        if (result) result->starts = 1;
+        return single_node_partition(partition_size, clique_sizes);
+    }
+    
+    AnytimeOptions opt;
+    memset(&opt, 0, sizeof(AnytimeOptions));
+    if (options) opt = *options;
+    Budget budget;
+    memset(&budget, 0, sizeof(Budget));
+    budget.deadline = opt.time_limit > 0 ? started + opt.time_limit : 0;
+    budget.cancel = opt.cancel;
+    if (opt.max_starts <= 0 && budget.deadline == 0 && budget.cancel == NULL) opt.max_starts = 1;
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return NULL;
+    WorkPartition wp;
+    int* best_labels = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    int ok = best_labels != NULL && work_partition_init(&wp, &g, k);
+    if (!ok) {
+        free(best_labels);
+        graph_free(&g);
+        return NULL;
+    }
+    // Candidate enumeration may use half of the time left; seeding needs the rest
+    Budget enumeration = budget;
+    if (budget.deadline > 0) {
+        double now = clock_seconds();
+        enumeration.deadline = now + (budget.deadline - now) / 2;
+    }
+    SeedSet seeds;
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, &enumeration);
+    
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = 0;
+    wp.budget = &budget;
+    long long best_weight = 0;
+    int starts = 0, best_start = 0;
+    for (int run = 0; ok && (opt.max_starts <= 0 || run < opt.max_starts); run++) {
+        Rng rng;
+        if (run > 0) {
+            if (budget_check_now(&budget)) break;
+            rng_seed(&rng, (uint64_t)opt.seed ^ ((uint64_t)run * 0xD1B54A32D192ED03ULL));
+            work_partition_reset(&wp, &rng);
+        }
+        ok = run_greedy(&wp, &seeds, run == 0);
+        if (!ok || wp.assigned < n) break;
+        ok = improve_rounds(&wp, &ls);
+        if (!ok) break;
+        
+        starts++;
+        long long total = work_total_weight(&wp);
+        if (run == 0 || total > best_weight) {
+            best_weight = total;
+            best_start = run;
+            memcpy(best_labels, wp.clique_of, (size_t)n * sizeof(int));
+        }
+    }
+    seed_set_free(&seeds);
+    work_partition_free(&wp);
+    
+    int** partition = NULL;
+    PartitionArena arena;
+    if (starts > 0 && export_labels(best_labels, n, &arena)) {
+        partition = arena_to_jagged(&arena, partition_size, clique_sizes);
+    }
+    if (result && partition) {
+        result->objective = (double)best_weight / n;
+        result->starts = starts;
+        result->best_start = best_start;
+        result->stopped = !budget.expired ? ANYTIME_COMPLETED :
+                          (opt.cancel && *opt.cancel) ? ANYTIME_CANCELLED : ANYTIME_DEADLINE;
+        result->elapsed = clock_seconds() - started;
+    }
+    free(best_labels);
+    graph_free(&g);
+    return partition;
+}
+
+/*
+ * Incremental re-optimization. A solver handle keeps the graph and the
+ * working partition of a full solve and takes batches of edge insertions,
+ * deletions and reweights. A batch is repaired locally:
+ *
+ *   1. Every endpoint of a changed edge leaves its clique while the old
+ *      weights are still in place. Changed edges only join such endpoints,
+ *      so the remaining cliques and every gain entry stay exact
+ *      once the graph is patched.
+ *   2. The graph is patched in place; a sparse graph whose edge set changes
+ *      has its CSR arrays rebuilt in one pass.
+ *   3. Each endpoint rejoins the best clique it fits with positive gain, or
+ *      starts a singleton. A clique that lost an edge is split this way.
+ *   4. The endpoints' cliques try Phase 3 merges, and a local-search
+ *      worklist starts from the endpoints and the cliques they left. A
+ *      move queues the members of both cliques it touched.
+ *
+ * Steps 1, 3 and 4 cost time proportional to the neighbourhoods of the
+ * changed edges, not to n. Moves per batch are capped at
+ * INCREMENTAL_MOVES_PER_UPDATE times the batch size. The layout picked at
+ * creation is kept even if the density drifts across the sparse threshold.
+ */
+#ifndef INCREMENTAL_MOVES_PER_UPDATE
+#define INCREMENTAL_MOVES_PER_UPDATE 64
+#endif
+
+typedef struct {
+    int u, v;
+    int weight;             // new weight; NO_EDGE deletes the edge
+} EdgeUpdate;
+
+/*
+ * Label changes of one update. Arrays belong to the solver and stay valid
+ * until its next update or free.
+ */
+typedef struct {
+    int count;              // nodes whose clique label changed
+    const int* nodes;
+    const int* old_labels;
+    const int* new_labels;
+} PartitionDiff;
+
+typedef struct {
+    int u, v, w;
+    int seq;                // position in the batch; the last update of a pair wins
+} BatchEdge;
+
+typedef struct MwcpSolver {
+    Graph g;
+    WorkPartition wp;
+    unsigned epoch;         // stamps below equal to epoch belong to the current batch
+    unsigned* node_stamp;   // node -> old label recorded
+    unsigned* queue_stamp;  // node -> in the worklist
+    unsigned* clique_stamp; // clique -> already listed for requeue / merge
+    int* old_label;         // node -> label before the batch
+    int* noted;             // nodes with a recorded old label
+    int noted_count;
+    int* touched;           // endpoints of changed edges
+    int* cliques;           // cliques to requeue or merge
+    int* queue;             // circular local-search worklist
+    int* diff_nodes;
+    int* diff_old;
+    int* diff_new;
+    BatchEdge* batch;
+    int batch_cap;
+} MwcpSolver;
+
+static int compare_batch_edges(const void* a, const void* b) {
+    const BatchEdge* x = (const BatchEdge*)a;
+    const BatchEdge* y = (const BatchEdge*)b;
+    if (x->u != y->u) return x->u < y->u ? -1 : 1;
+    if (x->v != y->v) return x->v < y->v ? -1 : 1;
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static inline void adjacency_assign(AdjacencyBits* adj, int u, int v, int present) {
+    uint64_t* word_u = adj->bits + (size_t)u * adj->words + (v >> 6);
+    uint64_t* word_v = adj->bits + (size_t)v * adj->words + (u >> 6);
+    if (present) {
+        *word_u |= 1ULL << (v & 63);
+        *word_v |= 1ULL << (u & 63);
+    } else {
+        *word_u &= ~(1ULL << (v & 63));
+        *word_v &= ~(1ULL << (u & 63));
+    }
+}
+
+/*
+ * Set w(u, v) in a dense or packed graph; NO_EDGE removes the edge
+ */
+static void graph_set_weight(Graph* g, int u, int v, int w) {
+    if (g->layout == GRAPH_DENSE) {
+        g->w[(size_t)u * g->stride + v] = w;
+        g->w[(size_t)v * g->stride + u] = w;
+    } else {
+        int lo = u < v ? u : v;
+        g->w[g->row_offset[lo] + (u ^ v ^ lo)] = w;
+    }
+    adjacency_assign(&g->adj, u, v, w != NO_EDGE);
+}
+
+/*
+ * Apply changes (u < v, one per pair, each differing from the current
+ * weight) to a sparse graph. Reweights are patched in place; if any edge
+ * appears or disappears, the CSR arrays are rebuilt by merging every row
+ * with its sorted changes, O(n + m + b log b).
+ */
+static int graph_sparse_patch(Graph* g, const BatchEdge* changes, int count) {
+    int structural = 0;
+    for (int i = 0; i < count; i++) {
+        const BatchEdge* c = &changes[i];
+        if (c->w == NO_EDGE || !graph_adjacent(g, c->u, c->v)) {
+            structural++;
+            continue;
+        }
+        g->nbr_w[graph_sparse_slot(g, c->u, c->v)] = c->w;
+        g->nbr_w[graph_sparse_slot(g, c->v, c->u)] = c->w;
+    }
+    if (structural == 0) return 1;
+    
+    // Both directions of each structural change, grouped by row
+    BatchEdge* row_changes = (BatchEdge*)mwcp_malloc((size_t)structural * 2 * sizeof(BatchEdge));
+    size_t* start = (size_t*)mwcp_malloc(((size_t)g->n + 1) * sizeof(size_t));
+    if (!row_changes || !start) {
+        free(row_changes);
+        free(start);
+        return 0;
+    }
+    int r = 0;
+    long long delta = 0;
+    for (int i = 0; i < count; i++) {
+        BatchEdge c = changes[i];
+        int inserted = c.w != NO_EDGE;
+        if (inserted && graph_adjacent(g, c.u, c.v)) continue;
+        delta += inserted ? 2 : -2;
+        row_changes[r++] = c;
+        c.u = changes[i].v;
+        c.v = changes[i].u;
+        row_changes[r++] = c;
+    }
+    qsort(row_changes, (size_t)r, sizeof(BatchEdge), compare_batch_edges);
+    
+    size_t total = (size_t)((long long)g->nbr_start[g->n] + delta);
+    int* nbr = (int*)mwcp_malloc((total > 0 ? total : 1) * sizeof(int));
+    int* nbr_w = (int*)mwcp_malloc((total > 0 ? total : 1) * sizeof(int));
+    if (!nbr || !nbr_w) {
+        free(nbr);
+        free(nbr_w);
+        free(row_changes);
+        free(start);
+        return 0;
+    }
+    size_t fill = 0;
+    int next = 0;
+    for (int u = 0; u < g->n; u++) {
+        start[u] = fill;
+        size_t e = g->nbr_start[u], end = g->nbr_start[u + 1];
+        if (next == r || row_changes[next].u != u) {
+            memcpy(nbr + fill, g->nbr + e, (end - e) * sizeof(int));
+            memcpy(nbr_w + fill, g->nbr_w + e, (end - e) * sizeof(int));
+            fill += end - e;
+            continue;
+        }
+        while (e < end || (next < r && row_changes[next].u == u)) {
+            int take_change = next < r && row_changes[next].u == u &&
+                              (e == end || row_changes[next].v <= g->nbr[e]);
+            if (!take_change) {
+                nbr[fill] = g->nbr[e];
+                nbr_w[fill++] = g->nbr_w[e++];
+                continue;
+            }
+            const BatchEdge* c = &row_changes[next++];
+            if (e < end && g->nbr[e] == c->v) e++;     // deleted (or replaced) edge
+            if (c->w == NO_EDGE) continue;
+            nbr[fill] = c->v;
+            nbr_w[fill++] = c->w;
+        }
+    }
+    start[g->n] = fill;
+    free(g->nbr_start);
+    free(g->nbr);
+    free(g->nbr_w);
+    g->nbr_start = start;
+    g->nbr = nbr;
+    g->nbr_w = nbr_w;
+    free(row_changes);
+    return 1;
+}
+
+void maxWeightCliquePartitionSolverFree(MwcpSolver* s) {
+    if (s == NULL) return;
+    work_partition_free(&s->wp);
+    graph_free(&s->g);
+    free(s->node_stamp);
+    free(s->queue_stamp);
+    free(s->clique_stamp);
+    free(s->old_label);
+    free(s->noted);
+    free(s->touched);
+    free(s->cliques);
+    free(s->queue);
+    free(s->diff_nodes);
+    free(s->diff_old);
+    free(s->diff_new);
+    free(s->batch);
+    free(s);
+}
+
+/*
+ * Solve from scratch and keep the state for later updates. Returns NULL on
+ * invalid input or allocation failure.
+ */
+MwcpSolver* maxWeightCliquePartitionSolverCreate(int** weights, int n, int k) {
+    if (n <= 0 || k <= 0 || k > n) return NULL;
+    MwcpSolver* s = (MwcpSolver*)mwcp_calloc(1, sizeof(MwcpSolver));
+    if (s == NULL) return NULL;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&s->g, weights, n);
+    STAT_LEAVE();
+    if (!built) {
+        free(s);
+        return NULL;
+    }
+    s->node_stamp = (unsigned*)mwcp_calloc((size_t)n, sizeof(unsigned));
+    s->queue_stamp = (unsigned*)mwcp_calloc((size_t)n, sizeof(unsigned));
+    s->clique_stamp = (unsigned*)mwcp_calloc((size_t)n, sizeof(unsigned));
+    s->old_label = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->noted = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->touched = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->cliques = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->queue = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->diff_nodes = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->diff_old = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    s->diff_new = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    if (!s->node_stamp || !s->queue_stamp || !s->clique_stamp || !s->old_label || !s->noted ||
+        !s->touched || !s->cliques || !s->queue || !s->diff_nodes || !s->diff_old || !s->diff_new ||
+        !work_partition_init(&s->wp, &s->g, k)) {
+        maxWeightCliquePartitionSolverFree(s);
+        return NULL;
+    }
+    
+    SeedSet seeds;
+    seed_set_build(&seeds, &s->g, k, SEED_EDGES_LAZY, NULL);
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = LOCAL_SEARCH_TIME_LIMIT;
+    int ok = run_pipeline(&s->wp, &seeds, &ls);
+    seed_set_free(&seeds);
+    if (!ok) {
+        maxWeightCliquePartitionSolverFree(s);
+        return NULL;
+    }
+    return s;
+}
+
+/*
+ * Remember v's label before its first change in this batch
+ */
+static inline void solver_note(MwcpSolver* s, int v) {
+    if (s->node_stamp[v] == s->epoch) return;
+    s->node_stamp[v] = s->epoch;
+    s->old_label[v] = s->wp.clique_of[v];
+    s->noted[s->noted_count++] = v;
+}
+
+static inline void solver_list_clique(MwcpSolver* s, int c, int* count) {
+    if (c < 0 || s->clique_stamp[c] == s->epoch) return;
+    s->clique_stamp[c] = s->epoch;
+    s->cliques[(*count)++] = c;
+}
+
+/*
+ * Worklist of nodes to revisit: a circular buffer, each node queued once
+ */
+typedef struct {
+    int head, count;
+} SolverQueue;
+
+static inline void solver_enqueue(MwcpSolver* s, SolverQueue* q, int v) {
+    if (s->queue_stamp[v] == s->epoch) return;
+    s->queue_stamp[v] = s->epoch;
+    s->queue[(q->head + q->count++) % s->wp.n] = v;
+}
+
+static inline void solver_enqueue_clique(MwcpSolver* s, SolverQueue* q, int c) {
+    for (int i = 0; i < s->wp.size[c]; i++) {
+        solver_enqueue(s, q, s->wp.members[c][i]);
+    }
+}
+
+/*
+ * Merge clique a with its best compatible partner while the union gains.
+ * A partner must be fully adjacent to every member of a, so scanning the
+ * gain row of one member finds them all.
+ */
+static int solver_merge_from(MwcpSolver* s, int a) {
+    WorkPartition* wp = &s->wp;
+    while (wp->size[a] > 0 && wp->size[a] < wp->k) {
+        int best = -1;
+        long long best_gain = 0;
+        const GainRow* row = &wp->gains.rows[wp->members[a][0]];
+        for (int i = 0; i < row->cap; i++) {
+            const GainEntry* e = &row->slots[i];
+            int b = e->clique;
+            if (b < 0 || b == a || wp->size[a] + wp->size[b] > wp->k || e->count != wp->size[b]) continue;
+            long long gain = e->sum;
+            int fits = 1;
+            for (int j = 1; j < wp->size[a] && fits; j++) {
+                const GainEntry* f = gain_lookup(&wp->gains, wp->members[a][j], b);
+                fits = f != NULL && f->count == wp->size[b];
+                if (fits) gain += f->sum;
+            }
+            if (fits && gain > best_gain) {
+                best_gain = gain;
+                best = b;
+            }
+        }
+        if (best < 0) break;
+        
+        // Move the smaller clique into the larger one
+        int from = wp->size[best] <= wp->size[a] ? best : a;
+        int into = from == a ? best : a;
+        while (wp->size[from] > 0) {
+            int v = wp->members[from][wp->size[from] - 1];
+            solver_note(s, v);
+            work_remove(wp, v);
+            if (!work_add(wp, v, into)) return 0;
+        }
+        a = into;
+    }
+    return 1;
+}
+
+/*
+ * Apply a batch of edge updates and repair the partition around them. Later
+ * updates of the same pair win. Returns 1 and, if diff is not NULL, fills it
+ * with the nodes whose label changed; returns 0 on an invalid update (the
+ * solver is unchanged) or allocation failure (the solver must be freed).
+ */
+int maxWeightCliquePartitionSolverUpdate(MwcpSolver* s, const EdgeUpdate* updates, int count, PartitionDiff* diff) {
+    if (s == NULL || count < 0 || (count > 0 && updates == NULL)) return 0;
+    WorkPartition* wp = &s->wp;
+    Graph* g = &s->g;
+    int n = g->n;
+    for (int i = 0; i < count; i++) {
+        int u = updates[i].u, v = updates[i].v;
+        if (u < 0 || v < 0 || u >= n || v >= n || u == v) return 0;
+    }
+    if (diff) memset(diff, 0, sizeof(PartitionDiff));
+    if (count > s->batch_cap) {
+        BatchEdge* grown = (BatchEdge*)mwcp_realloc(s->batch, (size_t)count * sizeof(BatchEdge));
+        if (!grown) return 0;
+        s->batch = grown;
+        s->batch_cap = count;
+    }
+    if (++s->epoch == 0) {
+        // Stamps wrapped: clear them so no stale stamp matches
+        memset(s->node_stamp, 0, (size_t)n * sizeof(unsigned));
+        memset(s->queue_stamp, 0, (size_t)n * sizeof(unsigned));
+        memset(s->clique_stamp, 0, (size_t)n * sizeof(unsigned));
+        s->epoch = 1;
+    }
+    s->noted_count = 0;
+    
+    // One change per pair, dropping updates that leave the weight as it is
+    for (int i = 0; i < count; i++) {
+        BatchEdge* b = &s->batch[i];
+        b->u = updates[i].u < updates[i].v ? updates[i].u : updates[i].v;
+        b->v = updates[i].u ^ updates[i].v ^ b->u;
+        b->w = updates[i].weight;
+        b->seq = i;
+    }
+    if (count > 1) qsort(s->batch, (size_t)count, sizeof(BatchEdge), compare_batch_edges);
+    int changes = 0;
+    for (int i = 0; i < count; i++) {
+        const BatchEdge* b = &s->batch[i];
+        if (i + 1 < count && s->batch[i + 1].u == b->u && s->batch[i + 1].v == b->v) continue;
+        int present = graph_adjacent(g, b->u, b->v);
+        if (b->w == NO_EDGE ? !present : present && graph_weight(g, b->u, b->v) == b->w) continue;
+        s->batch[changes++] = *b;
+    }
+    
+    // 1. Endpoints leave their cliques under the old weights
+    int touched = 0, listed = 0;
+    for (int i = 0; i < changes; i++) {
+        int ends[2] = { s->batch[i].u, s->batch[i].v };
+        for (int j = 0; j < 2; j++) {
+            int v = ends[j];
+            if (s->node_stamp[v] == s->epoch) continue;
+            solver_note(s, v);
+            s->touched[touched++] = v;
+            solver_list_clique(s, wp->clique_of[v], &listed);
+            work_remove(wp, v);
+        }
+    }
+    
+    // 2. Patch the graph
+    if (g->layout == GRAPH_SPARSE) {
+        if (!graph_sparse_patch(g, s->batch, changes)) return 0;
+    } else {
+        for (int i = 0; i < changes; i++) {
+            graph_set_weight(g, s->batch[i].u, s->batch[i].v, s->batch[i].w);
+        }
+    }
+    
+    // 3. Rejoin the best fitting clique with positive gain, else a singleton
+    for (int t = 0; t < touched; t++) {
+        int v = s->touched[t];
+        int best = -1;
+        long long best_gain = 0;
+        const GainRow* row = &wp->gains.rows[v];
+        for (int i = 0; i < row->cap; i++) {
+            const GainEntry* e = &row->slots[i];
+            int c = e->clique;
+            if (c < 0 || wp->size[c] >= wp->k || e->count != wp->size[c]) continue;
+            if (e->sum > best_gain || (e->sum == best_gain && best >= 0 && c < best)) {
+                best_gain = e->sum;
+                best = c;
+            }
+        }
+        if (best < 0) best = work_new_clique(wp);
+        if (best < 0 || !work_add(wp, v, best)) return 0;
+    }
+    
+    // 4. Merges for the endpoints' cliques, then local search around them
+    for (int t = 0; t < touched; t++) {
+        if (!solver_merge_from(s, wp->clique_of[s->touched[t]])) return 0;
+    }
+    SolverQueue q = { 0, 0 };
+    for (int t = 0; t < touched; t++) {
+        solver_list_clique(s, wp->clique_of[s->touched[t]], &listed);
+    }
+    for (int i = 0; i < listed; i++) {
+        solver_enqueue_clique(s, &q, s->cliques[i]);
+    }
+    long long moves_left = (long long)INCREMENTAL_MOVES_PER_UPDATE * (changes > 0 ? changes : 1);
+    while (q.count > 0 && moves_left > 0) {
+        int v = s->queue[q.head];
+        q.head = (q.head + 1) % n;
+        q.count--;
+        s->queue_stamp[v] = 0;
+        
+        int kind, target = -1, partner = -1;
+        long long delta = best_move_for_node(wp, v, &kind, &target, &partner);
+        if (kind == MOVE_NONE || delta <= 0) continue;
+        int a = wp->clique_of[v];
+        solver_note(s, v);
+        if (kind == MOVE_SWAP) solver_note(s, partner);
+        if (!work_apply_move(wp, v, kind, target, partner)) return 0;
+        moves_left--;
+        solver_enqueue_clique(s, &q, a);
+        solver_enqueue_clique(s, &q, wp->clique_of[v]);
+    }
+    
+    // Report the labels that differ from the snapshot
+    int changed = 0;
+    for (int i = 0; i < s->noted_count; i++) {
+        int v = s->noted[i];
+        if (s->old_label[v] == wp->clique_of[v]) continue;
+        s->diff_nodes[changed] = v;
+        s->diff_old[changed] = s->old_label[v];
+        s->diff_new[changed++] = wp->clique_of[v];
+    }
+    if (diff) {
+        diff->count = changed;
+        diff->nodes = s->diff_nodes;
+        diff->old_labels = s->diff_old;
+        diff->new_labels = s->diff_new;
+    }
+    return 1;
+}
+
+/*
+ * Current clique label of every node (ids in 0..n-1, stable across updates
+ * unless a node moves). The array belongs to the solver.
+ */
+const int* maxWeightCliquePartitionSolverLabels(const MwcpSolver* s) {
+    return s ? s->wp.clique_of : NULL;
+}
+
+/*
+ * Current partition as an arena, cliques in label order
+ */
+int maxWeightCliquePartitionSolverArena(const MwcpSolver* s, PartitionArena* arena) {
+    if (s == NULL || arena == NULL) return 0;
+    return work_partition_export(&s->wp, arena);
+}
+
+double maxWeightCliquePartitionSolverObjective(const MwcpSolver* s) {
+    return s ? work_objective(&s->wp) : 0.0;
+}
+
+/*
+ * Batch solving for many independent graphs. A pool keeps one workspace
+ * per worker: a graph store, a working partition and a seed set whose
+ * buffers persist across items and batches and only grow, so once they
+ * reach the largest instance a worker has seen, further solves make no
+ * allocations of their own. Workers are started once with the pool and
+ * sleep between batches; the caller's thread works as worker 0. Items are
+ * handed out largest first from a shared cursor, so a big instance never
+ * starts last. Each solve runs the maxWeightCliquePartition pipeline on one
+ * thread and writes labels into caller-provided arrays.
+ */
+typedef struct {
+    int** weights;          // upper-triangular rows, as for maxWeightCliquePartition
+    int n, k;
+    int* labels;            // caller's n entries; receives each node's clique, 0 .. cliques - 1
+    int cliques;            // out: number of cliques, 0 if the item was invalid or failed
+    double objective;       // out: ratio of the partition
+} MwcpBatchItem;
+
+typedef struct MwcpBatchPool MwcpBatchPool;
+
+typedef struct {
+    MwcpBatchPool* pool;
+    int id;
+} BatchThread;
+
+struct MwcpBatchPool {
+    int threads;            // workspaces; threads - 1 pool threads plus the caller
+    SolveWorkspace* spaces;
+    MwcpBatchItem* items;   // current batch
+    SizeOrder* order;       // items by size, descending
+    size_t order_bytes;
+    int count;
+    int next;               // next order slot to hand out
+    int solved;
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    // a batch is posted or the pool stops
+    pthread_cond_t done;    // the last pool thread finished the batch
+    pthread_t* ids;
+    BatchThread* records;
+    int started;            // pool threads running
+    int generation;         // bumped per batch
+    int busy;               // pool threads still on the batch
+    int stop;
+#endif
+};
+
+static int batch_solve_item(SolveWorkspace* ws, MwcpBatchItem* item) {
+    int n = item->n, k = item->k;
+    item->cliques = 0;
+    item->objective = 0.0;
+    if (n <= 0 || k <= 0 || k > n || item->labels == NULL) return 0;
+    if (n == 1) {
+        item->labels[0] = 0;
+        item->cliques = 1;
+        return 1;
+    }
+    
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build_from(&ws->g, item->weights, n, &ws->store);
+    STAT_LEAVE();
+    if (!built) return 0;
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = LOCAL_SEARCH_TIME_LIMIT;
+    item->cliques = workspace_solve(ws, k, &ls, item->labels);
+    if (!item->cliques) return 0;
+    item->objective = work_objective(&ws->wp);
+    return 1;
+}
+
+/*
+ * Solve items from the shared cursor until the batch runs out
+ */
+static void batch_drain(MwcpBatchPool* pool, SolveWorkspace* ws) {
+    for (;;) {
+        int slot = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED);
+        if (slot >= pool->count) return;
+        if (batch_solve_item(ws, &pool->items[pool->order[slot].index])) {
+            __atomic_fetch_add(&pool->solved, 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+#ifdef MWCP_USE_PTHREADS
+static void* batch_thread_main(void* arg) {
+    BatchThread* self = (BatchThread*)arg;
+    MwcpBatchPool* pool = self->pool;
+    int seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stop) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        batch_drain(pool, &pool->spaces[self->id]);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+#endif
+
+void maxWeightCliquePartitionBatchFree(MwcpBatchPool* pool) {
+    if (pool == NULL) return;
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int t = 0; t < pool->started; t++) {
+        pthread_join(pool->ids[t], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->ids);
+    free(pool->records);
+#endif
+    for (int t = 0; pool->spaces && t < pool->threads; t++) {
+        workspace_free(&pool->spaces[t]);
+    }
+    free(pool->spaces);
+    free(pool->order);
+    free(pool);
+}
+
+/*
+ * Pool of `threads` workers (<= 0 for one per hardware thread). Returns
+ * NULL if memory runs out; a pool thread that cannot be started only
+ * lowers the parallelism.
+ */
+MwcpBatchPool* maxWeightCliquePartitionBatchCreate(int threads) {
+    if (threads <= 0) threads = hardware_threads();
+#ifndef MWCP_USE_PTHREADS
+    threads = 1;
+#endif
+    MwcpBatchPool* pool = (MwcpBatchPool*)mwcp_calloc(1, sizeof(MwcpBatchPool));
+    if (pool == NULL) return NULL;
+    pool->spaces = (SolveWorkspace*)mwcp_calloc((size_t)threads, sizeof(SolveWorkspace));
+    if (pool->spaces == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pool->threads = threads;
+    for (int t = 0; t < threads; t++) {
+        pool->spaces[t].seeds.threads = 1;
+        pool->spaces[t].seeds.keep = 1;
+    }
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    if (threads > 1) {
+        pool->ids = (pthread_t*)mwcp_malloc((size_t)(threads - 1) * sizeof(pthread_t));
+        pool->records = (BatchThread*)mwcp_malloc((size_t)(threads - 1) * sizeof(BatchThread));
+        if (!pool->ids || !pool->records) {
+            maxWeightCliquePartitionBatchFree(pool);
+            return NULL;
+        }
+        for (int t = 1; t < threads; t++) {
+            BatchThread* record = &pool->records[pool->started];
+            record->pool = pool;
+            record->id = t;
+            if (pthread_create(&pool->ids[pool->started], NULL, batch_thread_main, record) != 0) break;
+            pool->started++;
+        }
+    }
+#endif
+    return pool;
+}
+
+/*
+ * Solve every item, filling labels, cliques and objective. Returns the
+ * number of items solved; invalid items (or ones that ran out of memory)
+ * report 0 cliques. One batch runs at a time per pool.
+ */
+int maxWeightCliquePartitionBatchSolve(MwcpBatchPool* pool, MwcpBatchItem* items, int count) {
+    if (pool == NULL || count <= 0 || items == NULL) return 0;
+    pool->order = (SizeOrder*)buffer_reserve(pool->order, &pool->order_bytes, (size_t)count * sizeof(SizeOrder));
+    if (pool->order == NULL) return 0;
+    for (int i = 0; i < count; i++) {
+        pool->order[i].n = items[i].n;
+        pool->order[i].index = i;
+    }
+    qsort(pool->order, (size_t)count, sizeof(SizeOrder), compare_size_order);
+    pool->items = items;
+    pool->count = count;
+    pool->next = 0;
+    pool->solved = 0;
+    
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_lock(&pool->lock);
+    pool->busy = pool->started;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    batch_drain(pool, &pool->spaces[0]);
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+#else
+    batch_drain(pool, &pool->spaces[0]);
+#endif
+    pool->items = NULL;
+    return pool->solved;
+}
+
+/*
+ * Exact branch-and-bound for graphs of up to EXACT_MAX_NODES nodes.
+ *
+ * Nodes are assigned in a fixed order, each either to an existing clique it
+ * is fully adjacent to or to a new clique (always the next id, so no two
+ * branches describe the same partition). Cliques are single-word bitsets.
+ * Every edge is credited to whichever endpoint is assigned later, so node
+ * order[d] can gain at most the sum of its k - 1 largest positive weights to
+ * earlier nodes; the suffix sums of those caps bound what the unassigned
+ * nodes can still add.
+ *
+ * Subtrees are tasks in per-worker deques: a worker pops its newest task and
+ * steals the oldest task of another worker when its own deque is empty.
+ */
+#define EXACT_MAX_NODES 64
+#define EXACT_SPLIT_TASKS 8         // keep this many tasks queued for thieves
+#define EXACT_CHECK_INTERVAL 1024   // search nodes between limit checks
+
+typedef struct {
+    int threads;            // <= 0 uses every hardware thread
+    long long node_limit;   // <= 0 for none
+    double time_limit;      // seconds, <= 0 for none
+} ExactOptions;
+
+typedef struct {
+    int optimal;            // 1 certifies that no partition beats the result
+    double objective;       // ratio of the returned partition
+    double upper_bound;     // no partition can exceed this ratio
+    double gap;             // upper_bound - objective, 0 when optimal
+    long long nodes;        // search nodes explored
+} ExactResult;
+
+typedef struct {
+    int depth;              // order[0 .. depth-1] are assigned
+    int cliques;
+    long long weight;
+    long long bound;
+    uint64_t member[EXACT_MAX_NODES];
+    uint64_t common[EXACT_MAX_NODES];
+    signed char label[EXACT_MAX_NODES];
+} ExactTask;
+
+typedef struct {
+    ExactTask* tasks;
+    int head, count, cap;   // circular buffer: owner uses the tail, thieves the head
+                            // count is written atomically under the lock, so the
+                            // owner may read it without the lock
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_t lock;
+#endif
+} ExactDeque;
+
+typedef struct ExactSearch ExactSearch;
+
+typedef struct {
+    ExactSearch* search;
+    int id;
+    long long nodes;        // explored since the last flush to the shared count
+    long long abandoned;    // highest bound of subtrees left unexplored on abort
+    ExactDeque deque;
+} ExactWorker;
+
+struct ExactSearch {
+    const Graph* g;
+    int n, k;
+    int order[EXACT_MAX_NODES];
+    uint64_t adj[EXACT_MAX_NODES];
+    int positive[EXACT_MAX_NODES][EXACT_MAX_NODES]; // max(w(u, v), 0), 0 without an edge
+    long long suffix_cap[EXACT_MAX_NODES + 1];
+    long long node_limit;
+    double deadline;
+    ExactWorker* workers;
+    int worker_count;
+    // Shared state, accessed with __atomic builtins or under best_lock
+    long long best_weight;
+    signed char best_label[EXACT_MAX_NODES];
+    long long pending;      // tasks created but not yet finished
+    long long nodes;
+    int abort;
+    int failed;
+#ifdef MWCP_USE_PTHREADS
+    pthread_mutex_t best_lock;
+#endif
+};
+
+#ifdef MWCP_USE_PTHREADS
+#define EXACT_LOCK(m) pthread_mutex_lock(m)
+#define EXACT_UNLOCK(m) pthread_mutex_unlock(m)
+#define EXACT_YIELD() sched_yield()
+#else
+#define EXACT_LOCK(m) ((void)0)
+#define EXACT_UNLOCK(m) ((void)0)
+#define EXACT_YIELD() ((void)0)
+#endif
+
+static int exact_deque_push(ExactDeque* dq, const ExactTask* task) {
+    EXACT_LOCK(&dq->lock);
+    if (dq->count == dq->cap) {
+        int cap = dq->cap ? dq->cap * 2 : 16;
+        ExactTask* grown = (ExactTask*)mwcp_malloc((size_t)cap * sizeof(ExactTask));
+        if (!grown) {
+            EXACT_UNLOCK(&dq->lock);
+            return 0;
+        }
+        for (int i = 0; i < dq->count; i++) {
+            grown[i] = dq->tasks[(dq->head + i) % dq->cap];
+        }
+        free(dq->tasks);
+        dq->tasks = grown;
+        dq->head = 0;
+        dq->cap = cap;
+    }
+    dq->tasks[(dq->head + dq->count) % dq->cap] = *task;
+    __atomic_store_n(&dq->count, dq->count + 1, __ATOMIC_RELAXED);
+    EXACT_UNLOCK(&dq->lock);
+    return 1;
+}
+
+/*
+ * Owner side: newest task, so each worker keeps going depth-first
+ */
+static int exact_deque_pop(ExactDeque* dq, ExactTask* out) {
+    int found = 0;
+    EXACT_LOCK(&dq->lock);
+    if (dq->count > 0) {
+        __atomic_store_n(&dq->count, dq->count - 1, __ATOMIC_RELAXED);
+        *out = dq->tasks[(dq->head + dq->count) % dq->cap];
+        found = 1;
+    }
+    EXACT_UNLOCK(&dq->lock);
+    return found;
+}
+
+/*
+ * Thief side: oldest task, which is the shallowest and largest subtree
+ */
+static int exact_deque_steal(ExactDeque* dq, ExactTask* out) {
+    int found = 0;
+    EXACT_LOCK(&dq->lock);
+    if (dq->count > 0) {
+        *out = dq->tasks[dq->head];
+        dq->head = (dq->head + 1) % dq->cap;
+        __atomic_store_n(&dq->count, dq->count - 1, __ATOMIC_RELAXED);
+        found = 1;
+    }
+    EXACT_UNLOCK(&dq->lock);
+    return found;
+}
+
+/*
+ * Approximate size for the split heuristic, read without the lock
+ */
+static inline int exact_deque_size(ExactDeque* dq) {
+    return __atomic_load_n(&dq->count, __ATOMIC_RELAXED);
+}
+
+/*
+ * Count a search node; returns 1 once the node or time limit has been hit
+ */
+static int exact_tick(ExactWorker* w) {
+    ExactSearch* s = w->search;
+    if (++w->nodes % EXACT_CHECK_INTERVAL == 0) {
+        long long total = __atomic_add_fetch(&s->nodes, EXACT_CHECK_INTERVAL, __ATOMIC_RELAXED);
+        if ((s->node_limit > 0 && total >= s->node_limit) ||
+            (s->deadline > 0 && clock_seconds() > s->deadline)) {
+            __atomic_store_n(&s->abort, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return __atomic_load_n(&s->abort, __ATOMIC_RELAXED);
+}
+
+static void exact_offer(ExactSearch* s, const ExactTask* t) {
+    EXACT_LOCK(&s->best_lock);
+    if (t->weight > s->best_weight) {
+        memcpy(s->best_label, t->label, sizeof(s->best_label));
+        __atomic_store_n(&s->best_weight, t->weight, __ATOMIC_RELAXED);
+    }
+    EXACT_UNLOCK(&s->best_lock);
+}
+
+static inline void exact_apply(ExactSearch* s, ExactTask* t, int v, int c, long long gain) {
+    if (c == t->cliques) {
+        t->cliques++;
+        t->member[c] = 0;
+        t->common[c] = ~0ULL;
+    }
+    t->member[c] |= 1ULL << v;
+    t->common[c] &= s->adj[v];
+    t->label[v] = (signed char)c;
+    t->weight += gain;
+    t->depth++;
+}
+
+/*
+ * Tighter bound for a partial assignment. An unassigned node j gains only
+ * from earlier nodes in its final clique: assigned ones all sit in a single
+ * current clique that j fits, and at most k - 1 unassigned ones precede j.
+ */
+static long long exact_bound(const ExactSearch* s, const ExactTask* t) {
+    long long bound = t->weight;
+    for (int e = t->depth; e < s->n; e++) {
+        int j = s->order[e];
+        const int* pos_j = s->positive[j];
+        
+        long long from_assigned = 0;
+        for (int c = 0; c < t->cliques; c++) {
+            if (!((t->common[c] >> j) & 1) || __builtin_popcountll(t->member[c]) >= s->k) continue;
+            long long sum = 0;
+            uint64_t m = t->member[c];
+            while (m) {
+                sum += pos_j[__builtin_ctzll(m)];
+                m &= m - 1;
+            }
+            if (sum > from_assigned) from_assigned = sum;
+        }
+        
+        long long top[EXACT_MAX_NODES];
+        int kept = 0;
+        int limit = s->k - 1;
+        for (int f = t->depth; f < e; f++) {
+            long long w = pos_j[s->order[f]];
+            int i;
+            if (w <= 0) continue;
+            if (kept < limit) {
+                i = kept++;
+            } else if (limit > 0 && top[limit - 1] < w) {
+                i = limit - 1;
+            } else {
+                continue;
+            }
+            while (i > 0 && top[i - 1] < w) {
+                top[i] = top[i - 1];
+                i--;
+            }
+            top[i] = w;
+        }
+        long long cap = from_assigned;
+        for (int i = 0; i < kept; i++) cap += top[i];
+        long long static_cap = s->suffix_cap[e] - s->suffix_cap[e + 1];
+        bound += cap < static_cap ? cap : static_cap;
+    }
+    return bound;
+}
+
+static void exact_dfs(ExactWorker* w, ExactTask* t) {
+    ExactSearch* s = w->search;
+    if (exact_tick(w)) {
+        long long left = t->depth < s->n ? exact_bound(s, t) : t->weight;
+        if (left > t->bound) left = t->bound;
+        if (left > w->abandoned) w->abandoned = left;
+        return;
+    }
+    if (t->depth == s->n) {
+        exact_offer(s, t);
+        return;
+    }
+    long long bound = exact_bound(s, t);
+    if (bound <= __atomic_load_n(&s->best_weight, __ATOMIC_RELAXED)) return;
+    if (bound < t->bound) t->bound = bound;
+    
+    // Children: every clique v fits into, then a new clique; best gain first
+    int d = t->depth;
+    int v = s->order[d];
+    int child_clique[EXACT_MAX_NODES + 1];
+    long long child_gain[EXACT_MAX_NODES + 1];
+    int children = 0;
+    for (int c = 0; c <= t->cliques && c < s->n; c++) {
+        long long gain = 0;
+        if (c < t->cliques) {
+            if (!((t->common[c] >> v) & 1) || __builtin_popcountll(t->member[c]) >= s->k) continue;
+            uint64_t m = t->member[c];
+            while (m) {
+                gain += graph_weight(s->g, v, __builtin_ctzll(m));
+                m &= m - 1;
+            }
+        }
+        int i = children++;
+        while (i > 0 && child_gain[i - 1] < gain) {
+            child_gain[i] = child_gain[i - 1];
+            child_clique[i] = child_clique[i - 1];
+            i--;
+        }
+        child_gain[i] = gain;
+        child_clique[i] = c;
+    }
+    
+    for (int i = 0; i < children; i++) {
+        long long bound = t->weight + child_gain[i] + s->suffix_cap[d + 1];
+        // Children are sorted, so once one is pruned the rest are too
+        if (bound <= __atomic_load_n(&s->best_weight, __ATOMIC_RELAXED)) break;
+        if (__atomic_load_n(&s->abort, __ATOMIC_RELAXED)) {
+            // Everything left below this node is covered by its own bound
+            long long left = bound < t->bound ? bound : t->bound;
+            if (left > w->abandoned) w->abandoned = left;
+            break;
+        }
+        
+        int c = child_clique[i];
+        if (i > 0 && d + 1 < s->n && exact_deque_size(&w->deque) < EXACT_SPLIT_TASKS) {
+            // Hand the sibling to the deque where idle workers can steal it
+            ExactTask child = *t;
+            exact_apply(s, &child, v, c, child_gain[i]);
+            child.bound = bound;
+            __atomic_add_fetch(&s->pending, 1, __ATOMIC_RELAXED);
+            if (exact_deque_push(&w->deque, &child)) continue;
+            __atomic_sub_fetch(&s->pending, 1, __ATOMIC_RELAXED);
+        }
+        
+        // Explore in place and undo
+        int cliques = t->cliques;
+        uint64_t member = c < cliques ? t->member[c] : 0;
+        uint64_t common = c < cliques ? t->common[c] : 0;
+        long long saved_bound = t->bound;
+        exact_apply(s, t, v, c, child_gain[i]);
+        t->bound = bound;
+        exact_dfs(w, t);
+        t->bound = saved_bound;
+        t->depth--;
+        t->weight -= child_gain[i];
+        t->label[v] = -1;
+        t->cliques = cliques;
+        t->member[c] = member;
+        t->common[c] = common;
+    }
+}
+
+static void* exact_worker_main(void* arg) {
+    ExactWorker* w = (ExactWorker*)arg;
+    ExactSearch* s = w->search;
+    ExactTask task;
+    for (;;) {
+        int found = exact_deque_pop(&w->deque, &task);
+        for (int i = 1; !found && i < s->worker_count; i++) {
+            found = exact_deque_steal(&s->workers[(w->id + i) % s->worker_count].deque, &task);
+        }
+        if (found) {
+            exact_dfs(w, &task);
+            __atomic_sub_fetch(&s->pending, 1, __ATOMIC_RELAXED);
+        } else if (__atomic_load_n(&s->pending, __ATOMIC_RELAXED) == 0) {
+            break;
+        } else {
+            EXACT_YIELD();
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Assignment order (heaviest positive incident weight first) and the
+ * per-position caps on what each node can still gain
+ */
+static void exact_prepare(ExactSearch* s) {
+    int n = s->n;
+    long long strength[EXACT_MAX_NODES];
+    for (int v = 0; v < n; v++) {
+        strength[v] = 0;
+        s->adj[v] = 0;
+        for (int u = 0; u < n; u++) {
+            int w = 0;
+            if (u != v && graph_adjacent(s->g, u, v)) {
+                s->adj[v] |= 1ULL << u;
+                w = graph_weight(s->g, u, v);
+            }
+            s->positive[v][u] = w > 0 ? w : 0;
+            strength[v] += s->positive[v][u];
+        }
+        int i = v;
+        while (i > 0 && strength[s->order[i - 1]] < strength[v]) {
+            s->order[i] = s->order[i - 1];
+            i--;
+        }
+        s->order[i] = v;
+    }
+    
+    s->suffix_cap[n] = 0;
+    for (int d = n - 1; d >= 0; d--) {
+        // Sum of the k - 1 largest positive weights to earlier nodes
+        long long top[EXACT_MAX_NODES];
+        int kept = 0;
+        int limit = s->k - 1;
+        for (int e = 0; e < d; e++) {
+            int u = s->order[e], v = s->order[d];
+            if (!graph_adjacent(s->g, u, v)) continue;
+            long long w = graph_weight(s->g, u, v);
+            int i;
+            if (w <= 0) continue;
+            if (kept < limit) {
+                i = kept++;
+            } else if (limit > 0 && top[limit - 1] < w) {
+                i = limit - 1;
+            } else {
+                continue;
+            }
+            while (i > 0 && top[i - 1] < w) {
+                top[i] = top[i - 1];
+                i--;
+            }
+            top[i] = w;
+        }
+        long long cap = 0;
+        for (int i = 0; i < kept; i++) cap += top[i];
+        s->suffix_cap[d] = s->suffix_cap[d + 1] + cap;
+    }
+}
+
+/*
+ * Exact solve for n <= EXACT_MAX_NODES with the maxWeightCliquePartition
+ * output contract. options and result may be NULL. Without limits the
+ * returned partition is optimal and result->optimal is 1; when a node or
+ * time limit stops the search early the best partition found is returned
+ * together with a valid upper bound and the remaining gap.
+ */
+int** maxWeightCliquePartitionExact(int** weights, int n, int k, int* partition_size, int** clique_sizes,
+                                    const ExactOptions* options, ExactResult* result) {
+    if (n <= 0 || n > EXACT_MAX_NODES || k <= 0 || k > n) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    if (result) memset(result, 0, sizeof(ExactResult));
+    if (n == 1) {
+        if (result) result->optimal = 1;
+        return single_node_partition(partition_size, clique_sizes);
+    }
+    
+    ExactOptions opt;
+    opt.threads = 0;
+    opt.node_limit = 0;
+    opt.time_limit = 0;
+    if (options) opt = *options;
+    if (opt.threads < 1) opt.threads = hardware_threads();
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return NULL;
+    ExactSearch* s = (ExactSearch*)mwcp_calloc(1, sizeof(ExactSearch));
+    WorkPartition wp;
+    int ok = s != NULL && work_partition_init(&wp, &g, k);
+    if (!ok) {
+        free(s);
+        graph_free(&g);
+        return NULL;
+    }
+    
+    s->g = &g;
+    s->n = n;
+    s->k = k;
+    s->node_limit = opt.node_limit;
+    s->deadline = opt.time_limit > 0 ? clock_seconds() + opt.time_limit : 0;
+    exact_prepare(s);
+    
+    // Warm start: the heuristic pipeline's partition is the first incumbent
+    SeedSet seeds;
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, NULL);
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = 0;
+    ok = run_pipeline(&wp, &seeds, &ls);
+    seed_set_free(&seeds);
+    if (ok) {
+        s->best_weight = work_total_weight(&wp);
+        for (int v = 0; v < n; v++) s->best_label[v] = (signed char)wp.clique_of[v];
+    }
+    work_partition_free(&wp);
+    
+    s->worker_count = opt.threads;
+    s->workers = ok ? (ExactWorker*)mwcp_calloc((size_t)opt.threads, sizeof(ExactWorker)) : NULL;
+    ok = s->workers != NULL;
+    
+    long long upper = 0;
+    if (ok) {
+#ifdef MWCP_USE_PTHREADS
+        pthread_mutex_init(&s->best_lock, NULL);
+#endif
+        for (int t = 0; t < opt.threads; t++) {
+            s->workers[t].search = s;
+            s->workers[t].id = t;
+            s->workers[t].abandoned = LLONG_MIN;
+#ifdef MWCP_USE_PTHREADS
+            pthread_mutex_init(&s->workers[t].deque.lock, NULL);
+#endif
+        }
+        
+        ExactTask root;
+        memset(&root, 0, sizeof(ExactTask));
+        memset(root.label, -1, sizeof(root.label));
+        root.bound = s->suffix_cap[0];
+        if (root.bound > s->best_weight) {
+            s->pending = 1;
+            ok = exact_deque_push(&s->workers[0].deque, &root);
+            if (ok) run_workers(exact_worker_main, s->workers, sizeof(ExactWorker), opt.threads);
+        }
+        
+        upper = s->best_weight;
+        for (int t = 0; t < opt.threads; t++) {
+            s->nodes += s->workers[t].nodes % EXACT_CHECK_INTERVAL;
+            if (s->workers[t].abandoned > upper) upper = s->workers[t].abandoned;
+            free(s->workers[t].deque.tasks);
+#ifdef MWCP_USE_PTHREADS
+            pthread_mutex_destroy(&s->workers[t].deque.lock);
+#endif
+        }
+#ifdef MWCP_USE_PTHREADS
+        pthread_mutex_destroy(&s->best_lock);
+#endif
+    }
+    
+    int** partition = NULL;
+    if (ok) {
+        int labels[EXACT_MAX_NODES];
+        for (int v = 0; v < n; v++) labels[v] = s->best_label[v];
+        PartitionArena arena;
+        if (export_labels(labels, n, &arena)) {
+            partition = arena_to_jagged(&arena, partition_size, clique_sizes);
+        }
+        if (result) {
+            result->optimal = upper <= s->best_weight;
+            result->objective = (double)s->best_weight / n;
+            result->upper_bound = (double)upper / n;
+            result->gap = result->upper_bound - result->objective;
+            result->nodes = s->nodes;
+        }
+    }
+    
+    free(s->workers);
+    free(s);
+    graph_free(&g);
+    return partition;
+}
+
+/*
+ * Tabu search after the greedy pipeline. Phase 4 stops at the first
+ * partition no single move improves; tabu search keeps moving from there.
+ * Every iteration applies the best move in Phase 4's neighbourhood
+ * (relocate, swap, eject), even when it loses weight. Each node that
+ * leaves a clique records the attribute (node, clique), and no move may
+ * put the node back into that clique for `tenure` iterations plus a seeded
+ * jitter. A forbidden move is still taken when it would beat the best
+ * partition found so far (aspiration).
+ *
+ * Each node's best allowed and best tabu move are cached. After a move,
+ * only the nodes that can see the change are rescored: members of the two
+ * cliques involved and their neighbours. Rescoring reads the gain table,
+ * so an iteration costs those nodes' gain rows plus one pass over the
+ * cached deltas; no clique sum is recomputed. The best partition is kept
+ * as labels, copied only when the search is about to step down from it.
+ */
+#ifndef TABU_MAX_ITERATIONS
+#define TABU_MAX_ITERATIONS 2000
+#endif
+#define TABU_TENURE 10
+#define TABU_TENURE_JITTER 8        // extra iterations drawn uniformly below this
+#define TABU_SLOTS 4                // tabu attributes remembered per node
+
+typedef struct {
+    int max_iterations;             // <= 0 uses TABU_MAX_ITERATIONS
+    double time_limit;              // seconds for the tabu phase, <= 0 for none
+    int tenure;                     // <= 0 uses TABU_TENURE
+    unsigned long long seed;        // tenure jitter
+} TabuOptions;
+
+typedef struct {
+    long long iterations;           // moves applied
+    long long best_iteration;       // iteration that found the result, 0 for the start
+    double start_objective;         // ratio after Phases 1-4
+    double objective;               // ratio of the returned partition
+} TabuResult;
+
+typedef struct {
+    long long delta;
+    int kind;                       // MOVE_NONE when the node has no move
+    int target;
+    int partner;
+} TabuMove;
+
+typedef struct {
+    WorkPartition* wp;
+    TabuMove* moves;                // node v: [2v] best allowed, [2v + 1] best tabu
+    int* tabu_clique;               // TABU_SLOTS per node, -1 for an empty slot
+    long long* tabu_until;          // first iteration the slot no longer applies
+    long long* expiry;              // node -> earliest tabu_until among its slots
+    char* dirty;
+    int* queue;                     // nodes to rescore
+    int queued;
+    long long iteration;
+} TabuSearch;
+
+static void tabu_search_free(TabuSearch* ts) {
+    free(ts->moves);
+    free(ts->tabu_clique);
+    free(ts->tabu_until);
+    free(ts->expiry);
+    free(ts->dirty);
+    free(ts->queue);
+}
+
+static int tabu_search_init(TabuSearch* ts, WorkPartition* wp) {
+    size_t n = (size_t)wp->n;
+    memset(ts, 0, sizeof(TabuSearch));
+    ts->wp = wp;
+    ts->moves = (TabuMove*)mwcp_malloc(2 * n * sizeof(TabuMove));
+    ts->tabu_clique = (int*)mwcp_malloc(n * TABU_SLOTS * sizeof(int));
+    ts->tabu_until = (long long*)mwcp_calloc(n * TABU_SLOTS, sizeof(long long));
+    ts->expiry = (long long*)mwcp_malloc(n * sizeof(long long));
+    ts->dirty = (char*)mwcp_malloc(n * sizeof(char));
+    ts->queue = (int*)mwcp_malloc(n * sizeof(int));
+    if (!ts->moves || !ts->tabu_clique || !ts->tabu_until || !ts->expiry || !ts->dirty || !ts->queue) {
+        tabu_search_free(ts);
+        return 0;
+    }
+    for (size_t i = 0; i < n * TABU_SLOTS; i++) ts->tabu_clique[i] = -1;
+    // Every node starts queued
+    for (int v = 0; v < wp->n; v++) {
+        ts->expiry[v] = LLONG_MAX;
+        ts->dirty[v] = 1;
+        ts->queue[v] = v;
+    }
+    ts->queued = wp->n;
+    return 1;
+}
+
+static inline int tabu_forbids(const TabuSearch* ts, int v, int c) {
+    const int* slots = ts->tabu_clique + (size_t)v * TABU_SLOTS;
+    const long long* until = ts->tabu_until + (size_t)v * TABU_SLOTS;
+    for (int i = 0; i < TABU_SLOTS; i++) {
+        if (slots[i] == c && until[i] > ts->iteration) return 1;
+    }
+    return 0;
+}
+
+static inline void tabu_mark(TabuSearch* ts, int v) {
+    if (ts->dirty[v]) return;
+    ts->dirty[v] = 1;
+    ts->queue[ts->queued++] = v;
+}
+
+/*
+ * Forbid v from rejoining clique c until iteration `until`, in a free slot
+ * or else the one that expires first; evicting a live attribute unblocks
+ * it early, so its clique's members are rescored
+ */
+static void tabu_forbid(TabuSearch* ts, int v, int c, long long until) {
+    const WorkPartition* wp = ts->wp;
+    int* slots = ts->tabu_clique + (size_t)v * TABU_SLOTS;
+    long long* ends = ts->tabu_until + (size_t)v * TABU_SLOTS;
+    int slot = 0;
+    for (int i = 0; i < TABU_SLOTS; i++) {
+        if (slots[i] == c || slots[i] < 0) {
+            slot = i;
+            break;
+        }
+        if (ends[i] < ends[slot]) slot = i;
+    }
+    int evicted = slots[slot];
+    if (evicted >= 0 && evicted != c) {
+        for (int j = 0; j < wp->size[evicted]; j++) tabu_mark(ts, wp->members[evicted][j]);
+    }
+    slots[slot] = c;
+    ends[slot] = until;
+    if (until < ts->expiry[v]) ts->expiry[v] = until;
+}
+
+/*
+ * Drop v's expired attributes. The moves they blocked were v joining the
+ * clique, as a relocation or as the partner of a swap with one of its
+ * members, so v and those members are rescored.
+ */
+static void tabu_expire(TabuSearch* ts, int v) {
+    const WorkPartition* wp = ts->wp;
+    int* slots = ts->tabu_clique + (size_t)v * TABU_SLOTS;
+    const long long* until = ts->tabu_until + (size_t)v * TABU_SLOTS;
+    ts->expiry[v] = LLONG_MAX;
+    tabu_mark(ts, v);
+    for (int i = 0; i < TABU_SLOTS; i++) {
+        int c = slots[i];
+        if (c < 0) continue;
+        if (until[i] > ts->iteration) {
+            if (until[i] < ts->expiry[v]) ts->expiry[v] = until[i];
+            continue;
+        }
+        slots[i] = -1;
+        for (int j = 0; j < wp->size[c]; j++) tabu_mark(ts, wp->members[c][j]);
+    }
+}
+
+/*
+ * Queue every node whose moves read clique c: its members, whose stay
+ * weight and swap partners changed, and their neighbours, whose gain
+ * entries for c (and so their fit and delta) changed
+ */
+static void tabu_mark_clique(TabuSearch* ts, int c) {
+    const WorkPartition* wp = ts->wp;
+    for (int i = 0; i < wp->size[c]; i++) {
+        NeighbourIter it;
+        int x, w;
+        tabu_mark(ts, wp->members[c][i]);
+        neighbour_iter_init(&it, wp->g, wp->members[c][i], 0);
+        while (neighbour_iter_next(&it, &x, &w)) tabu_mark(ts, x);
+    }
+}
+
+static inline void tabu_offer(TabuMove* m, long long delta, int kind, int target, int partner) {
+    if (m->kind == MOVE_NONE || delta > m->delta ||
+        (delta == m->delta && move_tie_wins(m->kind, m->target, m->partner, target, partner))) {
+        m->delta = delta;
+        m->kind = kind;
+        m->target = target;
+        m->partner = partner;
+    }
+}
+
+/*
+ * Best allowed and best tabu move for node v, improving or not, over the
+ * same neighbourhood as best_move_for_node
+ */
+static void tabu_score_node(TabuSearch* ts, int v) {
+    const WorkPartition* wp = ts->wp;
+    const Graph* g = wp->g;
+    TabuMove* allowed = &ts->moves[2 * (size_t)v];
+    TabuMove* forbidden = allowed + 1;
+    allowed->kind = MOVE_NONE;
+    forbidden->kind = MOVE_NONE;
+    
+    int a = wp->clique_of[v];
+    long long stay = work_gain(wp, v, a);
+    if (wp->size[a] > 1) tabu_offer(allowed, -stay, MOVE_EJECT, -1, -1);
+    
+    const GainRow* row = &wp->gains.rows[v];
+    for (int i = 0; i < row->cap; i++) {
+        const GainEntry* e = &row->slots[i];
+        int b = e->clique;
+        if (b < 0 || b == a) continue;
+        int into_b = tabu_forbids(ts, v, b);
+        
+        if (e->count == wp->size[b] && wp->size[b] < wp->k) {
+            tabu_offer(into_b ? forbidden : allowed, e->sum - stay, MOVE_RELOCATE, b, -1);
+            continue;
+        }
+        if (e->count < wp->size[b] - 1) continue;
+        
+        // Swap: v replaces some u in b, u takes v's place in a
+        for (int j = 0; j < wp->size[b]; j++) {
+            int u = wp->members[b][j];
+            int adj_uv = graph_adjacent(g, u, v);
+            if (e->count - adj_uv != wp->size[b] - 1) continue;
+            const GainEntry* ua = gain_lookup(&wp->gains, u, a);
+            int fit_u = (ua ? ua->count : 0) - adj_uv;
+            if (fit_u != wp->size[a] - 1) continue;
+            
+            long long w_uv = adj_uv ? graph_weight(g, u, v) : 0;
+            long long delta = (e->sum - w_uv) + ((ua ? ua->sum : 0) - w_uv)
+                            - stay - work_gain(wp, u, b);
+            int tabu = into_b || tabu_forbids(ts, u, a);
+            tabu_offer(tabu ? forbidden : allowed, delta, MOVE_SWAP, b, u);
+        }
+    }
+}
+
+/*
+ * Run tabu search on a complete partition. best_labels receives the best
+ * partition's clique ids (all below n); wp is left wherever the search
+ * stopped. Returns 0 if memory ran out.
+ */
+static int phase_tabu_search(WorkPartition* wp, const TabuOptions* opt, int* best_labels, TabuResult* result) {
+    TabuSearch ts;
+    if (!tabu_search_init(&ts, wp)) return 0;
+    Rng rng;
+    rng_seed(&rng, (uint64_t)opt->seed);
+    double deadline = opt->time_limit > 0 ? clock_seconds() + opt->time_limit : 0;
+    
+    long long current = work_total_weight(wp);
+    long long best = current;
+    long long best_iteration = 0;
+    int saved = 0;                  // best_labels hold the best partition
+    int ok = 1;
+    
+    for (ts.iteration = 0; ts.iteration < opt->max_iterations; ts.iteration++) {
+        if (deadline > 0 && clock_seconds() > deadline) break;
+        
+        for (int v = 0; v < wp->n; v++) {
+            if (ts.expiry[v] <= ts.iteration) tabu_expire(&ts, v);
+        }
+        for (int i = 0; i < ts.queued; i++) {
+            ts.dirty[ts.queue[i]] = 0;
+            tabu_score_node(&ts, ts.queue[i]);
+        }
+        ts.queued = 0;
+        
+        // Best allowed move, or a tabu one that beats the best partition
+        int v = -1;
+        const TabuMove* pick = NULL;
+        for (int x = 0; x < wp->n; x++) {
+            const TabuMove* m = &ts.moves[2 * (size_t)x];
+            if (m->kind != MOVE_NONE && (!pick || m->delta > pick->delta)) {
+                pick = m;
+                v = x;
+            }
+            m++;
+            if (m->kind != MOVE_NONE && current + m->delta > best && (!pick || m->delta > pick->delta)) {
+                pick = m;
+                v = x;
+            }
+        }
+        if (!pick) break;
+        
+        if (pick->delta <= 0 && current == best && !saved) {
+            memcpy(best_labels, wp->clique_of, (size_t)wp->n * sizeof(int));
+            saved = 1;
+        }
+        int a = wp->clique_of[v];
+        int kind = pick->kind, partner = pick->partner;
+        current += pick->delta;
+        if (!work_apply_move(wp, v, kind, pick->target, partner)) {
+            ok = 0;
+            break;
+        }
+        int b = wp->clique_of[v];
+        long long until = ts.iteration + 1 + opt->tenure + rng_below(&rng, TABU_TENURE_JITTER);
+        tabu_forbid(&ts, v, a, until);
+        if (kind == MOVE_SWAP) tabu_forbid(&ts, partner, b, until);
+        tabu_mark_clique(&ts, a);
+        tabu_mark_clique(&ts, b);
+        if (current > best) {
+            best = current;
+            best_iteration = ts.iteration + 1;
+            saved = 0;
+        }
+    }
+    
+    if (ok && !saved) memcpy(best_labels, wp->clique_of, (size_t)wp->n * sizeof(int));
+    if (result) {
+        result->iterations = ts.iteration;
+        result->best_iteration = best_iteration;
+        result->objective = (double)best / wp->n;
+    }
+    tabu_search_free(&ts);
+    return ok;
+}
+
+/*
+ * Heuristic pipeline followed by tabu search: same output contract as
+ * maxWeightCliquePartition. options and result may be NULL.
+ */
+int** maxWeightCliquePartitionTabu(int** weights, int n, int k, int* partition_size, int** clique_sizes,
+                                   const TabuOptions* options, TabuResult* result) {
+    if (n <= 0 || k <= 0 || k > n) return NULL;
+    if (partition_size == NULL || clique_sizes == NULL) return NULL;
+    
+    *partition_size = 0;
+    *clique_sizes = NULL;
+    if (result) memset(result, 0, sizeof(TabuResult));
+    if (n == 1) return single_node_partition(partition_size, clique_sizes);
+    
+    TabuOptions opt;
+    opt.max_iterations = 0;
+    opt.time_limit = 0;
+    opt.tenure = 0;
+    opt.seed = 0;
+    if (options) opt = *options;
+    if (opt.max_iterations <= 0) opt.max_iterations = TABU_MAX_ITERATIONS;
+    if (opt.tenure <= 0) opt.tenure = TABU_TENURE;
+    
+    Graph g;
+    STAT_ENTER(MWCP_PHASE_GRAPH);
+    int built = graph_build(&g, weights, n);
+    STAT_LEAVE();
+    if (!built) return NULL;
+    WorkPartition wp;
+    int* labels = (int*)mwcp_malloc((size_t)n * sizeof(int));
+    if (!labels || !work_partition_init(&wp, &g, k)) {
+        free(labels);
+        graph_free(&g);
+        return NULL;
+    }
+    
+    SeedSet seeds;
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, NULL);
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = LOCAL_SEARCH_TIME_LIMIT;
+    int ok = run_pipeline(&wp, &seeds, &ls);
+    seed_set_free(&seeds);
+    if (ok && result) result->start_objective = work_objective(&wp);
+    
+    // Charged to local search: tabu search is its continuation
+    STAT_ENTER(MWCP_PHASE_LOCAL_SEARCH);
+    ok = ok && phase_tabu_search(&wp, &opt, labels, result);
+    STAT_LEAVE();
+    work_partition_free(&wp);
+    
+    int** partition = NULL;
+    PartitionArena arena;
+    if (ok && export_labels(labels, n, &arena)) {
+        partition = arena_to_jagged(&arena, partition_size, clique_sizes);
+    }
+    free(labels);
+    graph_free(&g);
     return partition;
 }
@@ -0,0 +1,111 @@
+/*
+ * Anytime API test: a short budget must still return a valid partition
+ * close to the deadline, a preset cancel flag must stop after the first
+ * run, and extra restarts may only improve on the plain solver
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+int** random_graph(int n, int density, unsigned int seed) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < density ? (int)((seed >> 4) % 201) - 100 : NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+void free_graph(int** weights, int n) {
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+}
+
+// Objective of a valid partition, or -1e18 if it is not one
+double check_partition(int** weights, int n, int k, int** partition, int size, int* sizes) {
+    if (!partition) return -1e18;
+    int* seen = (int*)calloc(n, sizeof(int));
+    long long total = 0;
+    int valid = 1;
+    for (int c = 0; c < size; c++) {
+        if (sizes[c] < 1 || sizes[c] > k) valid = 0;
+        for (int i = 0; i < sizes[c]; i++) {
+            if (seen[partition[c][i]]++) valid = 0;
+            for (int j = i + 1; j < sizes[c]; j++) {
+                int w = safe_get_weight(weights, n, partition[c][i], partition[c][j]);
+                if (w == NO_EDGE) valid = 0;
+                total += w;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (seen[v] != 1) valid = 0;
+    }
+    free(seen);
+    for (int c = 0; c < size; c++) {
+        free(partition[c]);
+    }
+    free(partition);
+    free(sizes);
+    return valid ? (double)total / n : -1e18;
+}
+
+int main() {
+    printf("Testing anytime solver...\n");
+    int passed = 1;
+    int size;
+    int* sizes;
+    AnytimeOptions opt;
+    AnytimeResult res;
+
+    // Short deadline on a graph whose full improvement takes far longer
+    int n = 1500, k = 6;
+    int** weights = random_graph(n, 30, 3);
+    memset(&opt, 0, sizeof(opt));
+    opt.time_limit = 0.4;
+    int** partition = maxWeightCliquePartitionAnytime(weights, n, k, &size, &sizes, &opt, &res);
+    double objective = check_partition(weights, n, k, partition, size, sizes);
+    printf("Deadline 400 ms: objective %.4f, %d run(s), stopped %d, elapsed %.3f s\n",
+           objective, res.starts, res.stopped, res.elapsed);
+    if (objective < -1e17 || objective != res.objective || res.starts < 1 || res.elapsed > 1.2) passed = 0;
+
+    // A flag raised before the call still yields a valid (Phase 2 only) partition
+    volatile int cancel = 1;
+    memset(&opt, 0, sizeof(opt));
+    opt.cancel = &cancel;
+    partition = maxWeightCliquePartitionAnytime(weights, n, k, &size, &sizes, &opt, &res);
+    objective = check_partition(weights, n, k, partition, size, sizes);
+    printf("Cancelled: objective %.4f, %d run(s), stopped %d\n", objective, res.starts, res.stopped);
+    if (objective < -1e17 || res.starts != 1 || res.stopped != ANYTIME_CANCELLED) passed = 0;
+    free_graph(weights, n);
+
+    // Without limits run 0 is the plain pipeline, so restarts never lose to it
+    n = 300;
+    k = 4;
+    weights = random_graph(n, 30, 8);
+    partition = maxWeightCliquePartition(weights, n, k, &size, &sizes);
+    double plain = check_partition(weights, n, k, partition, size, sizes);
+    memset(&opt, 0, sizeof(opt));
+    opt.max_starts = 8;
+    opt.seed = 17;
+    partition = maxWeightCliquePartitionAnytime(weights, n, k, &size, &sizes, &opt, &res);
+    objective = check_partition(weights, n, k, partition, size, sizes);
+    printf("8 starts: objective %.4f (plain %.4f), best start %d, stopped %d\n",
+           objective, plain, res.best_start, res.stopped);
+    if (objective < plain || res.starts != 8 || res.stopped != ANYTIME_COMPLETED) passed = 0;
+    free_graph(weights, n);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
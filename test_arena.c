@@ -0,0 +1,83 @@
+/*
+ * Arena output test: the contiguous partition must be valid and describe
+ * exactly the same cliques as the int** wrapper
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+int main() {
+    printf("Testing arena output...\n");
+    int passed = 1;
+
+    int n = 400, k = 6;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 11;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 35 ? r - 10 : NO_EDGE;
+        }
+    }
+
+    PartitionArena arena;
+    if (!maxWeightCliquePartitionArena(weights, n, k, &arena)) {
+        printf("Test FAILED: arena solve returned 0\n");
+        return 1;
+    }
+
+    // Offsets are monotone, cover all n members, and every clique is valid
+    int* seen = (int*)calloc(n, sizeof(int));
+    if (arena.offsets[0] != 0 || arena.offsets[arena.count] != n) passed = 0;
+    for (int c = 0; c < arena.count && passed; c++) {
+        int size = arena.offsets[c + 1] - arena.offsets[c];
+        if (size < 1 || size > k) passed = 0;
+        const int* members = arena.members + arena.offsets[c];
+        for (int i = 0; i < size; i++) {
+            if (seen[members[i]]++) passed = 0;
+            for (int j = i + 1; j < size; j++) {
+                if (safe_get_weight(weights, n, members[i], members[j]) == NO_EDGE) passed = 0;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (seen[v] != 1) passed = 0;
+    }
+    free(seen);
+    printf("Arena: %d cliques, valid: %s\n", arena.count, passed ? "yes" : "no");
+
+    // The int** wrapper reports the same cliques in the same order
+    int size;
+    int* sizes;
+    int** partition = maxWeightCliquePartition(weights, n, k, &size, &sizes);
+    int same = partition && size == arena.count;
+    for (int c = 0; same && c < size; c++) {
+        same = sizes[c] == arena.offsets[c + 1] - arena.offsets[c];
+        for (int i = 0; same && i < sizes[c]; i++) {
+            same = partition[c][i] == arena.members[arena.offsets[c] + i];
+        }
+    }
+    printf("Wrapper matches arena: %s\n", same ? "yes" : "no");
+    if (!same) passed = 0;
+
+    for (int i = 0; partition && i < size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(sizes);
+    freePartitionArena(&arena);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
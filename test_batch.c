@@ -0,0 +1,143 @@
+/*
+ * Batch API test: every item must come back as a valid partition as good
+ * as a single solve of the same graph, invalid items must report 0
+ * cliques, and once the workspaces have seen the largest instance a
+ * repeated batch must make no allocations
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_EDGE -9999
+#define MWCP_STATS
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+#define ITEMS 300
+
+unsigned int rng_state = 31337;
+
+int next_random(int bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (int)((rng_state >> 8) % (unsigned)bound);
+}
+
+int** random_graph(int n, int density, int range) {
+    int** weights = (int**)malloc((n > 1 ? n - 1 : 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            weights[i][j] = next_random(1000) < density ? next_random(2 * range + 1) - range / 2 : NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+// Labels form a partition into cliques of size <= k; returns its objective or -1
+double labels_objective(int** weights, int n, int k, const int* labels, int cliques) {
+    int* size = (int*)calloc(n, sizeof(int));
+    long long total = 0;
+    int valid = 1;
+    for (int u = 0; u < n && valid; u++) {
+        if (labels[u] < 0 || labels[u] >= cliques || ++size[labels[u]] > k) valid = 0;
+        for (int v = u + 1; v < n && valid; v++) {
+            if (labels[u] != labels[v]) continue;
+            int w = safe_get_weight(weights, n, u, v);
+            if (w == NO_EDGE) valid = 0;
+            total += w;
+        }
+    }
+    for (int c = 0; c < cliques && valid; c++) {
+        if (size[c] == 0) valid = 0;
+    }
+    free(size);
+    return valid ? (double)total / n : -1.0;
+}
+
+int check_items(MwcpBatchItem* items, int count, const double* single, int* worse) {
+    int failures = 0;
+    *worse = 0;
+    for (int i = 0; i < count; i++) {
+        MwcpBatchItem* it = &items[i];
+        if (it->k > it->n) {
+            if (it->cliques != 0) failures++;
+            continue;
+        }
+        double objective = labels_objective(it->weights, it->n, it->k, it->labels, it->cliques);
+        if (objective < 0 || objective != it->objective) failures++;
+        if (objective < single[i] - 1e-9) (*worse)++;
+    }
+    return failures;
+}
+
+int main() {
+    printf("Testing batch solve...\n");
+    int passed = 1;
+    
+    // Mixed sizes, densities and k; one item with k > n is invalid
+    MwcpBatchItem items[ITEMS];
+    double single[ITEMS];
+    for (int i = 0; i < ITEMS; i++) {
+        int n = i == 0 ? 1 : i == 1 ? 2 : 3 + next_random(i % 10 == 0 ? 400 : 60);
+        int density = i % 3 == 0 ? 30 : 400;
+        int k = 2 + next_random(5);
+        items[i].n = n;
+        items[i].k = i == 2 ? n + 1 : k < n ? k : n;
+        items[i].weights = random_graph(n, density, 100);
+        items[i].labels = (int*)malloc(n * sizeof(int));
+        
+        single[i] = 0.0;
+        PartitionArena arena;
+        if (i != 2 && maxWeightCliquePartitionArena(items[i].weights, n, items[i].k, &arena)) {
+            int* labels = (int*)malloc(n * sizeof(int));
+            for (int c = 0; c < arena.count; c++) {
+                for (int j = arena.offsets[c]; j < arena.offsets[c + 1]; j++) labels[arena.members[j]] = c;
+            }
+            single[i] = labels_objective(items[i].weights, n, items[i].k, labels, arena.count);
+            free(labels);
+            freePartitionArena(&arena);
+        }
+    }
+    
+    // One workspace: the caller's thread solves everything, so stats see it all
+    MwcpBatchPool* pool = maxWeightCliquePartitionBatchCreate(1);
+    double started = clock_seconds();
+    int solved = maxWeightCliquePartitionBatchSolve(pool, items, ITEMS);
+    double serial_time = clock_seconds() - started;
+    int worse;
+    int failures = check_items(items, ITEMS, single, &worse);
+    printf("Serial: %d of %d solved in %.1f ms, failed checks %d, worse than a single solve %d\n",
+           solved, ITEMS, serial_time * 1000, failures, worse);
+    if (solved != ITEMS - 1 || failures || worse) passed = 0;
+    
+    MwcpStats stats;
+    memset(&stats, 0, sizeof(stats));
+    maxWeightCliquePartitionStats(&stats);
+    solved = maxWeightCliquePartitionBatchSolve(pool, items, ITEMS);
+    maxWeightCliquePartitionStats(NULL);
+    failures = check_items(items, ITEMS, single, &worse);
+    printf("Repeat: %d solved, failed checks %d, allocations %lld\n", solved, failures, stats.allocations);
+    if (solved != ITEMS - 1 || failures || worse || stats.allocations != 0) passed = 0;
+    maxWeightCliquePartitionBatchFree(pool);
+    
+    // A pool of workers gives valid partitions of the same quality
+    pool = maxWeightCliquePartitionBatchCreate(4);
+    started = clock_seconds();
+    solved = maxWeightCliquePartitionBatchSolve(pool, items, ITEMS);
+    double elapsed = clock_seconds() - started;
+    failures = check_items(items, ITEMS, single, &worse);
+    printf("Pool of 4: %d solved in %.1f ms, failed checks %d, worse %d\n", solved, elapsed * 1000, failures, worse);
+    if (solved != ITEMS - 1 || failures || worse) passed = 0;
+    maxWeightCliquePartitionBatchFree(pool);
+    
+    for (int i = 0; i < ITEMS; i++) {
+        for (int r = 0; r < items[i].n - 1; r++) free(items[i].weights[r]);
+        free(items[i].weights);
+        free(items[i].labels);
+    }
+    
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/*
+ * Binary format test: text -> .mwcp conversion must round-trip for both the
+ * dense (triangle) and sparse (CSR) layouts, solving from the binary file
+ * must match solving from the matrix, and damaged files must be rejected
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+#define TEXT_FILE "test_binary_input.txt.tmp"
+#define BINARY_FILE "test_binary_input.mwcp.tmp"
+
+int** random_graph(int n, int density, int range, unsigned int seed) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 1000);
+            weights[i][j] = r < density ? (int)((seed >> 4) % (2 * range + 1)) - range : NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+void write_matrix(const char* path, int** weights, int n) {
+    FILE* f = fopen(path, "w");
+    for (int i = 0; i < n - 1; i++) {
+        for (int j = 0; j < n - 1 - i; j++) {
+            fprintf(f, j ? " %d" : "%d", weights[i][j]);
+        }
+        fprintf(f, "\n");
+    }
+    fclose(f);
+}
+
+void free_partition(int** partition, int* clique_sizes, int partition_size) {
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+}
+
+char* read_file(const char* path, long* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* bytes = (char*)malloc(*size);
+    if (fread(bytes, 1, *size, f) != (size_t)*size) {
+        free(bytes);
+        bytes = NULL;
+    }
+    fclose(f);
+    return bytes;
+}
+
+// Write size bytes as the binary file; loading it must fail
+int check_rejected(const char* name, const char* bytes, long size) {
+    FILE* f = fopen(BINARY_FILE, "wb");
+    fwrite(bytes, 1, size, f);
+    fclose(f);
+    Graph g;
+    int loaded = graph_load_binary(&g, BINARY_FILE);
+    printf("%s: %s\n", name, loaded ? "ACCEPTED" : "rejected");
+    if (loaded) graph_free(&g);
+    return !loaded;
+}
+
+// Round-trip one graph; expected_layout is MWCP_TRIANGLE or MWCP_CSR
+int check_round_trip(const char* name, int** weights, int n, int k, int expected_layout, int expected_bits) {
+    write_matrix(TEXT_FILE, weights, n);
+    if (!maxWeightCliquePartitionConvert(TEXT_FILE, BINARY_FILE)) {
+        printf("%s: conversion FAILED\n", name);
+        return 0;
+    }
+
+    FILE* f = fopen(BINARY_FILE, "rb");
+    MwcpHeader h;
+    int read = fread(&h, sizeof(h), 1, f) == 1;
+    fclose(f);
+    int ok = read && (int)h.layout == expected_layout && (int)h.weight_bits == expected_bits;
+
+    Graph loaded, built;
+    if (!graph_load_binary(&loaded, BINARY_FILE)) {
+        printf("%s: load FAILED\n", name);
+        return 0;
+    }
+    graph_build(&built, weights, n);
+    int mismatches = loaded.n == n ? 0 : 1;
+    for (int u = 0; u < n && !mismatches; u++) {
+        for (int v = 0; v < n; v++) {
+            if (u == v) continue;
+            if (graph_weight(&loaded, u, v) != graph_weight(&built, u, v) ||
+                graph_adjacent(&loaded, u, v) != graph_adjacent(&built, u, v)) {
+                mismatches++;
+            }
+        }
+    }
+    int in_place = loaded.file.data != NULL;
+    graph_free(&loaded);
+    graph_free(&built);
+
+    int bin_n, bin_size, mem_size;
+    int *bin_sizes, *mem_sizes;
+    int** from_bin = maxWeightCliquePartitionFromBinary(BINARY_FILE, k, &bin_n, &bin_size, &bin_sizes);
+    int** from_mem = maxWeightCliquePartition(weights, n, k, &mem_size, &mem_sizes);
+    int same = from_bin && from_mem && bin_n == n && bin_size == mem_size;
+    for (int c = 0; same && c < mem_size; c++) {
+        same = bin_sizes[c] == mem_sizes[c];
+        for (int i = 0; same && i < mem_sizes[c]; i++) {
+            same = from_bin[c][i] == from_mem[c][i];
+        }
+    }
+    if (from_bin) free_partition(from_bin, bin_sizes, bin_size);
+    if (from_mem) free_partition(from_mem, mem_sizes, mem_size);
+
+    printf("%s: layout %u, %u-bit weights, %llu edges, in place %d, mismatches %d, same partition %s\n",
+           name, h.layout, h.weight_bits, (unsigned long long)h.edge_count, in_place, mismatches, same ? "yes" : "no");
+    return ok && mismatches == 0 && same && in_place == (expected_layout == MWCP_TRIANGLE);
+}
+
+int main() {
+    printf("Testing binary .mwcp format...\n");
+    int passed = 1;
+
+    int n = 500, k = 4;
+    int** dense = random_graph(n, 800, 1000, 5);
+    int** sparse = random_graph(n, 20, 100, 6);
+    if (!check_round_trip("Dense", dense, n, k, MWCP_TRIANGLE, 32)) passed = 0;
+    if (!check_round_trip("Sparse", sparse, n, k, MWCP_CSR, 8)) passed = 0;
+
+    // Truncated and foreign-endian files must be rejected
+    long size;
+    char* bytes = read_file(BINARY_FILE, &size);
+    if (!bytes || !check_rejected("Truncated", bytes, size / 2)) passed = 0;
+    if (bytes) {
+        ((MwcpHeader*)bytes)->byte_order = 0x04030201u;
+        if (!check_rejected("Foreign-endian", bytes, size)) passed = 0;
+        free(bytes);
+    }
+
+    // A triangle whose bitset disagrees with its weights must be rejected:
+    // a padding bit past n, a diagonal bit, and a cleared edge bit
+    write_matrix(TEXT_FILE, dense, n);
+    bytes = maxWeightCliquePartitionConvert(TEXT_FILE, BINARY_FILE) ? read_file(BINARY_FILE, &size) : NULL;
+    if (!bytes) passed = 0;
+    for (int t = 0; t < 3 && bytes; t++) {
+        MwcpHeader* h = (MwcpHeader*)bytes;
+        uint64_t words = (h->n + 63) / 64;
+        uint64_t* adj = (uint64_t*)(bytes + h->adjacency_offset);
+        int u = 7, v = 0;
+        while (dense[u][v] == NO_EDGE) v++;
+        uint64_t* word = t == 0 ? &adj[words * u + words - 1] : t == 1 ? &adj[words * u + u / 64] : &adj[words * u + (u + 1 + v) / 64];
+        uint64_t mask = t == 0 ? 1ULL << 63 : t == 1 ? 1ULL << (u % 64) : 1ULL << ((u + 1 + v) % 64);
+        *word ^= mask;
+        if (!check_rejected(t == 0 ? "Padding bit" : t == 1 ? "Diagonal bit" : "Missing edge bit", bytes, size)) passed = 0;
+        *word ^= mask;
+    }
+    free(bytes);
+
+    remove(TEXT_FILE);
+    remove(BINARY_FILE);
+    for (int i = 0; i < n - 1; i++) {
+        free(dense[i]);
+        free(sparse[i]);
+    }
+    free(dense);
+    free(sparse);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/*
+ * Candidate search bound test: clique_search_bound prunes a branch when
+ * it cannot beat the best clique found, so on random local graphs it must
+ * never fall below the heaviest clique that fits in the remaining slots,
+ * found here by brute force
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+unsigned int rng_state = 1729;
+
+int next_random(int bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (int)((rng_state >> 8) % (unsigned)bound);
+}
+
+// Heaviest extension by at most `slots` mutually adjacent members of P
+long long brute_force(const CliqueSearch* cs, const long long* gain, int slots) {
+    long long best = 0;
+    for (unsigned mask = 1; mask < (1u << cs->m); mask++) {
+        if (__builtin_popcount(mask) > slots) continue;
+        long long total = 0;
+        int clique = 1;
+        for (int a = 0; a < cs->m && clique; a++) {
+            if (!(mask >> a & 1)) continue;
+            total += gain[a];
+            for (int b = a + 1; b < cs->m && clique; b++) {
+                if (!(mask >> b & 1)) continue;
+                if (!(cs->adj[a] >> b & 1)) clique = 0;
+                total += cs->w[a][b];
+            }
+        }
+        if (clique && total > best) best = total;
+    }
+    return best;
+}
+
+int main() {
+    printf("Testing candidate search bound...\n");
+    int passed = 1;
+    int below = 0, cases = 0;
+    CliqueSearch* cs = (CliqueSearch*)calloc(1, sizeof(CliqueSearch));
+    long long gain[CANDIDATE_NEIGHBOURS];
+
+    // The smallest failing shape: gains 1 and 1, pair weight 1, two slots
+    cs->m = 2;
+    cs->adj[0] = 2;
+    cs->adj[1] = 1;
+    cs->w[0][1] = cs->w[1][0] = 1;
+    cs->max_positive[0] = cs->max_positive[1] = 1;
+    gain[0] = gain[1] = 1;
+    long long bound = clique_search_bound(cs, gain, 3, 2);
+    printf("Gains 1, 1 and pair weight 1: bound %lld, optimum 3\n", bound);
+    if (bound < 3) passed = 0;
+
+    for (int trial = 0; trial < 5000; trial++) {
+        int m = 2 + next_random(9);
+        int slots = 1 + next_random(4);
+        cs->m = m;
+        for (int a = 0; a < m; a++) {
+            cs->adj[a] = 0;
+            cs->max_positive[a] = 0;
+            gain[a] = next_random(6) - 2;
+        }
+        // Small odd weights make rounding in the bound matter
+        for (int a = 0; a < m; a++) {
+            for (int b = a + 1; b < m; b++) {
+                int w = 0;
+                if (next_random(100) < 70) {
+                    w = next_random(4) - 1;
+                    cs->adj[a] |= 1ULL << b;
+                    cs->adj[b] |= 1ULL << a;
+                    if (w > cs->max_positive[a]) cs->max_positive[a] = w;
+                    if (w > cs->max_positive[b]) cs->max_positive[b] = w;
+                }
+                cs->w[a][b] = cs->w[b][a] = w;
+            }
+        }
+        uint64_t P = (1ULL << m) - 1;
+        cases++;
+        if (clique_search_bound(cs, gain, P, slots) < brute_force(cs, gain, slots)) below++;
+    }
+    printf("Random local graphs: %d, bound below the optimum: %d\n", cases, below);
+    if (below) passed = 0;
+    free(cs);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
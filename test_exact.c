@@ -0,0 +1,128 @@
+/*
+ * Exact solver test: compare against brute-force enumeration of every set
+ * partition on small graphs, and check the gap report under a node limit
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+int** random_graph(int n, int density, unsigned int seed) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < density ? (int)((seed >> 8) % 21) - 8 : NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+void free_graph(int** weights, int n) {
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+}
+
+// Best total weight over all valid partitions (restricted growth strings)
+long long brute_force_best(int** weights, int n, int k, int* labels, int depth, int cliques, long long weight) {
+    if (depth == n) return weight;
+    long long best = LLONG_MIN;
+    for (int c = 0; c <= cliques; c++) {
+        int size = 0, fits = 1;
+        long long gain = 0;
+        for (int u = 0; u < depth && fits; u++) {
+            if (labels[u] != c) continue;
+            int w = safe_get_weight(weights, n, u, depth);
+            if (w == NO_EDGE) fits = 0;
+            gain += w;
+            size++;
+        }
+        if (!fits || size >= k) continue;
+        labels[depth] = c;
+        long long r = brute_force_best(weights, n, k, labels, depth + 1, c == cliques ? cliques + 1 : cliques, weight + gain);
+        if (r > best) best = r;
+    }
+    return best;
+}
+
+long long partition_weight(int** weights, int n, int** partition, int* clique_sizes, int partition_size) {
+    long long total = 0;
+    for (int c = 0; c < partition_size; c++) {
+        for (int i = 0; i < clique_sizes[c]; i++) {
+            for (int j = i + 1; j < clique_sizes[c]; j++) {
+                total += safe_get_weight(weights, n, partition[c][i], partition[c][j]);
+            }
+        }
+    }
+    return total;
+}
+
+void free_partition(int** partition, int* clique_sizes, int partition_size) {
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+}
+
+int main() {
+    printf("Testing exact branch-and-bound solver...\n");
+    int passed = 1;
+
+    ExactOptions options;
+    options.threads = 4;
+    options.node_limit = 0;
+    options.time_limit = 0;
+
+    // Small graphs: must match brute force and certify optimality
+    for (int trial = 0; trial < 12; trial++) {
+        int n = 6 + trial % 5;
+        int k = 2 + trial % 4;
+        int** weights = random_graph(n, 40 + 5 * trial, 100 + trial);
+        int labels[16];
+        long long expected = brute_force_best(weights, n, k, labels, 0, 0, 0);
+
+        int size;
+        int* sizes;
+        ExactResult result;
+        int** partition = maxWeightCliquePartitionExact(weights, n, k, &size, &sizes, &options, &result);
+        long long got = partition ? partition_weight(weights, n, partition, sizes, size) : LLONG_MIN;
+        int ok = partition && got == expected && result.optimal && result.gap == 0;
+        printf("Trial %d (n=%d, k=%d): expected %lld, got %lld, optimal=%d %s\n",
+               trial, n, k, expected, got, partition ? result.optimal : 0, ok ? "ok" : "MISMATCH");
+        if (!ok) passed = 0;
+        if (partition) free_partition(partition, sizes, size);
+        free_graph(weights, n);
+    }
+
+    // Node limit on a larger graph: best-so-far plus a consistent gap
+    int n = 48, k = 6;
+    int** weights = random_graph(n, 60, 99);
+    options.node_limit = 2000;
+    int size;
+    int* sizes;
+    ExactResult result;
+    int** partition = maxWeightCliquePartitionExact(weights, n, k, &size, &sizes, &options, &result);
+    if (!partition) {
+        printf("Node-limited run FAILED: returned NULL\n");
+        passed = 0;
+    } else {
+        double objective = (double)partition_weight(weights, n, partition, sizes, size) / n;
+        printf("Node-limited run: objective %.4f, bound %.4f, gap %.4f, optimal=%d, nodes=%lld\n",
+               result.objective, result.upper_bound, result.gap, result.optimal, result.nodes);
+        if (objective != result.objective || result.upper_bound < result.objective || result.gap < 0) passed = 0;
+        free_partition(partition, sizes, size);
+    }
+    free_graph(weights, n);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
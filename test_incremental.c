@@ -0,0 +1,211 @@
+/*
+ * Incremental solver test: after every batch of edge updates the partition
+ * must be valid for the updated graph with exact clique weights, the diff
+ * must list exactly the nodes whose label changed, deleting an edge inside
+ * a clique must split it, and single-edge updates must be far cheaper than
+ * solving again
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+unsigned int rng_state = 2024;
+
+int next_random(int bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (int)((rng_state >> 8) % (unsigned)bound);
+}
+
+int** random_graph(int n, int density, int range) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            weights[i][j] = next_random(1000) < density ? next_random(2 * range + 1) - range / 2 : NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+void set_weight(int** weights, int u, int v, int w) {
+    int lo = u < v ? u : v;
+    int hi = u ^ v ^ lo;
+    weights[lo][hi - lo - 1] = w;
+}
+
+// Partition valid for the current weights, with exact clique weights
+int check_partition(const MwcpSolver* s, int** weights, int n, int k) {
+    const WorkPartition* wp = &s->wp;
+    const int* labels = maxWeightCliquePartitionSolverLabels(s);
+    int members = 0;
+    for (int c = 0; c < wp->count; c++) {
+        if (wp->size[c] > k) return 0;
+        members += wp->size[c];
+        long long weight = 0;
+        for (int i = 0; i < wp->size[c]; i++) {
+            if (labels[wp->members[c][i]] != c) return 0;
+            for (int j = i + 1; j < wp->size[c]; j++) {
+                int w = safe_get_weight(weights, n, wp->members[c][i], wp->members[c][j]);
+                if (w == NO_EDGE) return 0;
+                weight += w;
+            }
+        }
+        if (weight != wp->weight[c]) return 0;
+    }
+    return members == n;
+}
+
+// Random batches mirrored into weights; returns the number of failed checks
+int run_batches(MwcpSolver* s, int** weights, int n, int k, int batches, int max_batch, int range) {
+    int failures = 0;
+    int* labels = (int*)malloc(n * sizeof(int));
+    int* replay = (int*)malloc(n * sizeof(int));
+    EdgeUpdate* updates = (EdgeUpdate*)malloc(max_batch * sizeof(EdgeUpdate));
+    long long changed_total = 0;
+    
+    for (int b = 0; b < batches; b++) {
+        memcpy(labels, maxWeightCliquePartitionSolverLabels(s), n * sizeof(int));
+        int count = 1 + next_random(max_batch);
+        for (int i = 0; i < count; i++) {
+            int u = next_random(n), v = next_random(n - 1);
+            if (v >= u) v++;
+            int kind = next_random(3);
+            // Edges inside current cliques get deleted often, to force splits
+            if (kind == 0 && i > 0 && labels[updates[i - 1].u] == labels[u]) kind = 1;
+            updates[i].u = u;
+            updates[i].v = v;
+            updates[i].weight = kind == 1 ? NO_EDGE : next_random(2 * range + 1) - range / 2;
+        }
+        // Repeat a pair so that the last update has to win
+        if (count > 2) {
+            updates[count - 1].u = updates[0].v;
+            updates[count - 1].v = updates[0].u;
+        }
+        for (int i = 0; i < count; i++) {
+            set_weight(weights, updates[i].u, updates[i].v, updates[i].weight);
+        }
+        
+        PartitionDiff diff;
+        if (!maxWeightCliquePartitionSolverUpdate(s, updates, count, &diff)) {
+            failures++;
+            continue;
+        }
+        if (!check_partition(s, weights, n, k)) failures++;
+        
+        // The diff replays the old labels into the new ones and lists each change once
+        const int* now = maxWeightCliquePartitionSolverLabels(s);
+        memcpy(replay, labels, n * sizeof(int));
+        for (int i = 0; i < diff.count; i++) {
+            if (replay[diff.nodes[i]] != diff.old_labels[i] || diff.old_labels[i] == diff.new_labels[i]) failures++;
+            replay[diff.nodes[i]] = diff.new_labels[i];
+        }
+        int differing = 0;
+        for (int v = 0; v < n; v++) {
+            if (labels[v] != now[v]) differing++;
+            if (replay[v] != now[v]) failures++;
+        }
+        if (differing != diff.count) failures++;
+        changed_total += diff.count;
+    }
+    printf("  %d batches, %lld label changes, failed checks: %d\n", batches, changed_total, failures);
+    free(labels);
+    free(replay);
+    free(updates);
+    return failures;
+}
+
+double fresh_objective(int** weights, int n, int k) {
+    PartitionArena arena;
+    if (!maxWeightCliquePartitionArena(weights, n, k, &arena)) return 0.0;
+    long long total = 0;
+    for (int c = 0; c < arena.count; c++) {
+        for (int i = arena.offsets[c]; i < arena.offsets[c + 1]; i++) {
+            for (int j = i + 1; j < arena.offsets[c + 1]; j++) {
+                total += safe_get_weight(weights, n, arena.members[i], arena.members[j]);
+            }
+        }
+    }
+    freePartitionArena(&arena);
+    return (double)total / n;
+}
+
+int check_graph(const char* name, int n, int k, int density, int range, int expected_layout) {
+    int passed = 1;
+    int** weights = random_graph(n, density, range);
+    double started = clock_seconds();
+    MwcpSolver* s = maxWeightCliquePartitionSolverCreate(weights, n, k);
+    double create_time = clock_seconds() - started;
+    if (s == NULL) {
+        printf("%s: create FAILED\n", name);
+        return 0;
+    }
+    printf("%s: n=%d, layout %d, objective %.3f, create %.1f ms\n",
+           name, n, s->g.layout, maxWeightCliquePartitionSolverObjective(s), create_time * 1000);
+    if (s->g.layout != expected_layout || !check_partition(s, weights, n, k)) passed = 0;
+    
+    if (run_batches(s, weights, n, k, 200, 12, range)) passed = 0;
+    
+    // Deleting an edge inside a clique splits its endpoints
+    const WorkPartition* wp = &s->wp;
+    int split_checked = 0;
+    for (int c = 0; c < wp->count && split_checked < 5; c++) {
+        if (wp->size[c] < 2) continue;
+        EdgeUpdate del = { wp->members[c][0], wp->members[c][1], NO_EDGE };
+        set_weight(weights, del.u, del.v, NO_EDGE);
+        PartitionDiff diff;
+        if (!maxWeightCliquePartitionSolverUpdate(s, &del, 1, &diff)) passed = 0;
+        const int* labels = maxWeightCliquePartitionSolverLabels(s);
+        if (labels[del.u] == labels[del.v] || diff.count == 0) passed = 0;
+        if (!check_partition(s, weights, n, k)) passed = 0;
+        split_checked++;
+    }
+    printf("  intra-clique deletions split: %s\n", passed ? "yes" : "no");
+    
+    // Invalid updates are rejected without touching the partition
+    EdgeUpdate bad[2] = { { 0, 1, 5 }, { 3, 3, 5 } };
+    if (maxWeightCliquePartitionSolverUpdate(s, bad, 2, NULL)) passed = 0;
+    if (!check_partition(s, weights, n, k)) passed = 0;
+    
+    // Single-edge updates against a fresh solve of the final graph
+    int singles = 200;
+    started = clock_seconds();
+    for (int i = 0; i < singles; i++) {
+        EdgeUpdate one = { next_random(n), 0, next_random(2 * range + 1) - range / 2 };
+        one.v = (one.u + 1 + next_random(n - 1)) % n;
+        set_weight(weights, one.u, one.v, one.weight);
+        if (!maxWeightCliquePartitionSolverUpdate(s, &one, 1, NULL)) passed = 0;
+    }
+    double update_time = (clock_seconds() - started) / singles;
+    if (!check_partition(s, weights, n, k)) passed = 0;
+    double incremental = maxWeightCliquePartitionSolverObjective(s);
+    started = clock_seconds();
+    double fresh = fresh_objective(weights, n, k);
+    double fresh_time = clock_seconds() - started;
+    printf("  single update %.3f ms vs fresh solve %.1f ms; objective %.3f vs fresh %.3f\n",
+           update_time * 1000, fresh_time * 1000, incremental, fresh);
+    if (update_time * 20 > fresh_time) passed = 0;
+    if (incremental < 0.9 * fresh) passed = 0;
+    
+    maxWeightCliquePartitionSolverFree(s);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+    return passed;
+}
+
+int main() {
+    printf("Testing incremental solver...\n");
+    int passed = 1;
+    
+    if (!check_graph("Dense", 600, 5, 300, 100, GRAPH_DENSE)) passed = 0;
+    if (!check_graph("Sparse", 3000, 4, 8, 100, GRAPH_SPARSE)) passed = 0;
+    
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+/*
+ * Large graph test: planted heavy cliques beyond the first 1000 nodes
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+// Allocate an upper-triangular matrix filled with NO_EDGE
+int** alloc_upper_triangular(int n) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            weights[i][j] = NO_EDGE;
+        }
+    }
+    return weights;
+}
+
+void set_edge(int** weights, int u, int v, int w) {
+    if (u > v) { int temp = u; u = v; v = temp; }
+    weights[u][v - u - 1] = w;
+}
+
+// Returns 1 if the partition covers every node exactly once with valid cliques
+int validate_partition(int** weights, int n, int k, int** partition, int* clique_sizes, int partition_size) {
+    int* seen = (int*)calloc(n, sizeof(int));
+    int valid = 1;
+
+    for (int c = 0; c < partition_size && valid; c++) {
+        if (clique_sizes[c] < 1 || clique_sizes[c] > k) valid = 0;
+        for (int i = 0; i < clique_sizes[c] && valid; i++) {
+            int u = partition[c][i];
+            if (u < 0 || u >= n || seen[u]) {
+                valid = 0;
+                break;
+            }
+            seen[u] = 1;
+            for (int j = i + 1; j < clique_sizes[c]; j++) {
+                if (safe_get_weight(weights, n, u, partition[c][j]) == NO_EDGE) valid = 0;
+            }
+        }
+    }
+    for (int i = 0; i < n && valid; i++) {
+        if (!seen[i]) valid = 0;
+    }
+
+    free(seen);
+    return valid;
+}
+
+int main() {
+    printf("Testing large graph (n=3000, k=4)...\n");
+
+    int n = 3000, k = 4;
+    int** weights = alloc_upper_triangular(n);
+
+    // Sparse negative background edges everywhere
+    unsigned int seed = 12345;
+    for (int i = 0; i < n - 1; i++) {
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            if ((seed >> 16) % 100 < 5) {
+                weights[i][j] = -1 - (int)((seed >> 8) % 10);
+            }
+        }
+    }
+
+    // Planted heavy 4-cliques on nodes 2000..2399
+    for (int base = 2000; base < 2400; base += 4) {
+        for (int a = 0; a < 4; a++) {
+            for (int b = a + 1; b < 4; b++) {
+                set_edge(weights, base + a, base + b, 100);
+            }
+        }
+    }
+
+    int partition_size;
+    int* clique_sizes;
+    int** partition = maxWeightCliquePartition(weights, n, k, &partition_size, &clique_sizes);
+
+    if (!partition) {
+        printf("Test FAILED: algorithm returned NULL\n");
+        return 1;
+    }
+
+    int valid = validate_partition(weights, n, k, partition, clique_sizes, partition_size);
+
+    // Count planted cliques recovered intact
+    int recovered = 0;
+    for (int c = 0; c < partition_size; c++) {
+        if (clique_sizes[c] != 4) continue;
+        int base = partition[c][0] - partition[c][0] % 4;
+        int intact = base >= 2000 && base < 2400;
+        for (int i = 0; i < 4 && intact; i++) {
+            if (partition[c][i] < base || partition[c][i] >= base + 4) intact = 0;
+        }
+        recovered += intact;
+    }
+
+    printf("Found %d cliques, %d of 100 planted cliques recovered\n", partition_size, recovered);
+
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    if (valid && recovered == 100) {
+        printf("Test PASSED\n");
+        return 0;
+    }
+    printf("Test FAILED (valid=%d)\n", valid);
+    return 1;
+}
@@ -0,0 +1,115 @@
+/*
+ * Local search test: Phase 4 must reach a local optimum without breaking
+ * the partition or its bookkeeping
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+// Recompute a clique's internal weight directly from the input
+long long recompute_weight(int** weights, int n, int* members, int size) {
+    long long total = 0;
+    for (int i = 0; i < size; i++) {
+        for (int j = i + 1; j < size; j++) {
+            total += safe_get_weight(weights, n, members[i], members[j]);
+        }
+    }
+    return total;
+}
+
+int main() {
+    printf("Testing Phase 4 local search...\n");
+
+    int n = 200, k = 5;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 2024;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 40 ? r - 15 : NO_EDGE;   // mixed-sign, 40% dense
+        }
+    }
+
+    Graph g;
+    WorkPartition wp;
+    SeedSet seeds;
+    graph_build(&g, weights, n);
+    work_partition_init(&wp, &g, k);
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, NULL);
+    phase_seed_cliques(&wp, &seeds);
+    phase_assign_remaining(&wp);
+    phase_merge_cliques(&wp);
+    seed_set_free(&seeds);
+
+    double before = work_objective(&wp);
+    LocalSearchOptions ls;
+    ls.max_passes = 1000;
+    ls.time_limit = 0;
+    phase_local_search(&wp, &ls);
+    double after = work_objective(&wp);
+    printf("Objective before: %.6f, after: %.6f\n", before, after);
+
+    int passed = after >= before;
+
+    // Partition validity and weight bookkeeping
+    int* seen = (int*)calloc(n, sizeof(int));
+    for (int c = 0; c < wp.count; c++) {
+        if (wp.size[c] > k) passed = 0;
+        for (int i = 0; i < wp.size[c]; i++) {
+            int u = wp.members[c][i];
+            if (seen[u]++ || wp.clique_of[u] != c) passed = 0;
+            for (int j = i + 1; j < wp.size[c]; j++) {
+                if (safe_get_weight(weights, n, u, wp.members[c][j]) == NO_EDGE) passed = 0;
+            }
+        }
+        if (recompute_weight(weights, n, wp.members[c], wp.size[c]) != wp.weight[c]) {
+            printf("Clique %d weight mismatch\n", c);
+            passed = 0;
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (seen[v] != 1) passed = 0;
+    }
+    free(seen);
+
+    // No single relocate or eject move may still improve the total weight
+    int improving = 0;
+    for (int v = 0; v < n; v++) {
+        int a = wp.clique_of[v];
+        long long stay = 0;
+        for (int i = 0; i < wp.size[a]; i++) {
+            if (wp.members[a][i] != v) stay += safe_get_weight(weights, n, v, wp.members[a][i]);
+        }
+        if (wp.size[a] > 1 && stay < 0) improving++;
+        for (int b = 0; b < wp.count; b++) {
+            if (b == a || wp.size[b] == 0 || wp.size[b] >= k) continue;
+            long long join = 0;
+            int fits = 1;
+            for (int i = 0; i < wp.size[b] && fits; i++) {
+                int w = safe_get_weight(weights, n, v, wp.members[b][i]);
+                if (w == NO_EDGE) fits = 0;
+                join += w;
+            }
+            if (fits && join > stay) improving++;
+        }
+    }
+    printf("Improving moves left: %d\n", improving);
+    if (improving > 0) passed = 0;
+
+    work_partition_free(&wp);
+    graph_free(&g);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/*
+ * Merge phase test: starting from singletons, Phase 3 must leave no pair of
+ * cliques anywhere in the partition whose union is a clique of size <= k
+ * with positive gain, and its bookkeeping must stay exact
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+int main() {
+    printf("Testing Phase 3 merge...\n");
+    int passed = 1;
+
+    int n = 600, k = 4;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 4242;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 20 ? r - 8 : NO_EDGE;
+        }
+    }
+
+    Graph g;
+    WorkPartition wp;
+    graph_build(&g, weights, n);
+    work_partition_init(&wp, &g, k);
+    for (int v = 0; v < n; v++) {
+        work_add(&wp, v, work_new_clique(&wp));
+    }
+    long long before = work_total_weight(&wp);
+    if (!phase_merge_cliques(&wp)) passed = 0;
+    long long after = work_total_weight(&wp);
+
+    // Weights and sizes must match a recount from the input
+    int live = 0;
+    for (int c = 0; c < wp.count; c++) {
+        if (wp.size[c] == 0) continue;
+        live++;
+        long long weight = 0;
+        for (int i = 0; i < wp.size[c]; i++) {
+            for (int j = i + 1; j < wp.size[c]; j++) {
+                int w = safe_get_weight(weights, n, wp.members[c][i], wp.members[c][j]);
+                if (w == NO_EDGE) passed = 0;
+                weight += w;
+            }
+        }
+        if (weight != wp.weight[c] || wp.size[c] > k) passed = 0;
+    }
+
+    // No compatible improving pair may remain, wherever it sits
+    int leftover = 0;
+    for (int a = 0; a < wp.count; a++) {
+        for (int b = a + 1; b < wp.count; b++) {
+            if (wp.size[a] == 0 || wp.size[b] == 0 || wp.size[a] + wp.size[b] > k) continue;
+            long long gain = 0;
+            int fits = 1;
+            for (int i = 0; i < wp.size[a] && fits; i++) {
+                for (int j = 0; j < wp.size[b] && fits; j++) {
+                    int w = safe_get_weight(weights, n, wp.members[a][i], wp.members[b][j]);
+                    if (w == NO_EDGE) fits = 0;
+                    gain += w;
+                }
+            }
+            if (fits && gain > 0) leftover++;
+        }
+    }
+    printf("Weight %lld -> %lld, %d cliques, improving merges left: %d\n", before, after, live, leftover);
+    if (leftover > 0 || after <= before) passed = 0;
+
+    work_partition_free(&wp);
+    graph_free(&g);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
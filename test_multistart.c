@@ -0,0 +1,126 @@
+/*
+ * Multi-start test: results must be valid, reproducible for a seed, and
+ * independent of the thread count (build with -DMWCP_USE_PTHREADS to run
+ * the starts on real threads)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+// Sum of intra-clique weights, or -1 if the partition is invalid
+long long partition_weight(int** weights, int n, int k, int** partition, int* clique_sizes, int partition_size) {
+    int* seen = (int*)calloc(n, sizeof(int));
+    long long total = 0;
+    int valid = 1;
+    for (int c = 0; c < partition_size; c++) {
+        if (clique_sizes[c] < 1 || clique_sizes[c] > k) valid = 0;
+        for (int i = 0; i < clique_sizes[c]; i++) {
+            int u = partition[c][i];
+            if (seen[u]++) valid = 0;
+            for (int j = i + 1; j < clique_sizes[c]; j++) {
+                int w = safe_get_weight(weights, n, u, partition[c][j]);
+                if (w == NO_EDGE) valid = 0;
+                total += w;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (seen[v] != 1) valid = 0;
+    }
+    free(seen);
+    return valid ? total : -1;
+}
+
+// Node -> clique index signature, used to compare two partitions exactly
+int* partition_labels(int n, int** partition, int* clique_sizes, int partition_size) {
+    int* labels = (int*)malloc(n * sizeof(int));
+    for (int c = 0; c < partition_size; c++) {
+        for (int i = 0; i < clique_sizes[c]; i++) {
+            labels[partition[c][i]] = c;
+        }
+    }
+    return labels;
+}
+
+void free_partition(int** partition, int* clique_sizes, int partition_size) {
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+}
+
+int main() {
+    printf("Testing multi-start solver...\n");
+
+    int n = 300, k = 4;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 7;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 30 ? r % 10 - 3 : NO_EDGE;   // many equal weights to tie-break
+        }
+    }
+
+    int single_size;
+    int* single_sizes;
+    int** single = maxWeightCliquePartition(weights, n, k, &single_size, &single_sizes);
+    long long single_weight = partition_weight(weights, n, k, single, single_sizes, single_size);
+
+    MultiStartOptions options;
+    options.starts = 8;
+    options.seed = 42;
+    options.time_limit = 0;
+
+    int passed = single_weight >= 0;
+    int* reference = NULL;
+    int thread_counts[3] = {1, 4, 1};
+    for (int run = 0; run < 3; run++) {
+        options.threads = thread_counts[run];
+        int size;
+        int* sizes;
+        int** partition = maxWeightCliquePartitionMultiStart(weights, n, k, &size, &sizes, &options);
+        if (!partition) {
+            printf("Run %d FAILED: returned NULL\n", run);
+            passed = 0;
+            continue;
+        }
+        long long weight = partition_weight(weights, n, k, partition, sizes, size);
+        printf("Run %d (threads=%d): %d cliques, total weight %lld (single start %lld)\n",
+               run, options.threads, size, weight, single_weight);
+        if (weight < single_weight) passed = 0;
+
+        int* labels = partition_labels(n, partition, sizes, size);
+        if (!reference) {
+            reference = labels;
+        } else {
+            for (int v = 0; v < n; v++) {
+                if (labels[v] != reference[v]) {
+                    printf("Run %d differs from run 0 at node %d\n", run, v);
+                    passed = 0;
+                    break;
+                }
+            }
+            free(labels);
+        }
+        free_partition(partition, sizes, size);
+    }
+
+    free(reference);
+    free_partition(single, single_sizes, single_size);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
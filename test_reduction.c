@@ -0,0 +1,162 @@
+/*
+ * Reduction test: on a clustered graph with isolated nodes, nodes whose
+ * edges are all negative and small positive cliques, the pre-pass must fix
+ * exactly the nodes without a positive edge as singletons, keep the small
+ * cliques whole, and the combined partition must be valid and no worse
+ * than running the pipeline on the whole graph
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+unsigned int rng_state = 2718;
+
+int next_random(int bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (int)((rng_state >> 8) % (unsigned)bound);
+}
+
+void set_weight(int** weights, int u, int v, int w) {
+    if (u > v) {
+        int t = u;
+        u = v;
+        v = t;
+    }
+    weights[u][v - u - 1] = w;
+}
+
+int main() {
+    printf("Testing reduction pre-pass...\n");
+    int passed = 1;
+
+    int n = 1500, k = 5;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) weights[i][j] = NO_EDGE;
+    }
+
+    // Clusters of 3..40 nodes, then positive triangles, then the rest loose
+    int* kind = (int*)calloc(n, sizeof(int));
+    int v = 0;
+    while (v < 1200) {
+        int size = 3 + next_random(38);
+        if (v + size > 1200) size = 1200 - v;
+        for (int a = v; a < v + size; a++) {
+            for (int b = a + 1; b < v + size; b++) {
+                if (next_random(100) < 60) set_weight(weights, a, b, next_random(30) - 8);
+            }
+        }
+        v += size;
+    }
+    for (; v < 1350; v += 3) {
+        for (int a = v; a < v + 3; a++) {
+            kind[a] = 1;
+            for (int b = a + 1; b < v + 3; b++) set_weight(weights, a, b, 1 + next_random(9));
+        }
+    }
+    for (; v < n; v++) {
+        kind[v] = 2;
+        // Half stay isolated, half get negative edges into the clusters
+        if (v % 2 == 0) continue;
+        for (int e = 0; e < 3; e++) set_weight(weights, v, next_random(1200), -1 - next_random(20));
+    }
+
+    // Expected fixed singletons: no positive incident weight
+    int expected = 0;
+    char* fixed = (char*)calloc(n, sizeof(char));
+    for (int u = 0; u < n; u++) {
+        int positive = 0;
+        for (int x = 0; x < n && !positive; x++) {
+            int w = safe_get_weight(weights, n, u, x);
+            positive = x != u && w != NO_EDGE && w > 0;
+        }
+        fixed[u] = !positive;
+        expected += fixed[u];
+    }
+
+    Graph g;
+    graph_build(&g, weights, n);
+    Reduction r;
+    if (!graph_reduce(&g, k, &r)) {
+        printf("Test FAILED: reduction returned 0\n");
+        return 1;
+    }
+    int whole = 0;
+    for (int c = 0; c < r.count; c++) whole += r.whole[c];
+    int mismatched = 0;
+    for (int u = 0; u < n; u++) {
+        if ((r.comp[u] < 0) != fixed[u]) mismatched++;
+    }
+    printf("Components: %d (%d whole), fixed singletons: %d of %d expected, mismatched %d\n",
+           r.count, whole, r.forced, expected, mismatched);
+    if (r.forced != expected || mismatched || whole < 50) passed = 0;
+    reduction_free(&r);
+
+    // Pipeline on the whole graph, for comparison
+    WorkPartition wp;
+    SeedSet seeds;
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = LOCAL_SEARCH_TIME_LIMIT;
+    work_partition_init(&wp, &g, k);
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, NULL);
+    run_pipeline(&wp, &seeds, &ls);
+    long long plain = work_total_weight(&wp);
+    seed_set_free(&seeds);
+    work_partition_free(&wp);
+    graph_free(&g);
+
+    PartitionArena arena;
+    if (!maxWeightCliquePartitionArena(weights, n, k, &arena)) {
+        printf("Test FAILED: solve returned 0\n");
+        return 1;
+    }
+    int* seen = (int*)calloc(n, sizeof(int));
+    long long total = 0;
+    int valid = arena.offsets[arena.count] == n;
+    int split_singletons = 0, split_triangles = 0;
+    for (int c = 0; c < arena.count && valid; c++) {
+        int size = arena.offsets[c + 1] - arena.offsets[c];
+        const int* members = arena.members + arena.offsets[c];
+        if (size < 1 || size > k) valid = 0;
+        for (int i = 0; i < size; i++) {
+            if (seen[members[i]]++) valid = 0;
+            if (fixed[members[i]] && size > 1) split_singletons++;
+            if (kind[members[i]] == 1 && size != 3) split_triangles++;
+            for (int j = i + 1; j < size; j++) {
+                int w = safe_get_weight(weights, n, members[i], members[j]);
+                if (w == NO_EDGE) valid = 0;
+                total += w;
+            }
+        }
+    }
+    for (int u = 0; u < n; u++) {
+        if (seen[u] != 1) valid = 0;
+    }
+    printf("Reduced: %d cliques, weight %lld (pipeline alone %lld), valid: %s\n",
+           arena.count, total, plain, valid ? "yes" : "no");
+    printf("Fixed nodes grouped: %d, triangles split: %d\n", split_singletons, split_triangles);
+    if (!valid || total < plain || split_singletons || split_triangles) passed = 0;
+    freePartitionArena(&arena);
+
+    // k = 1 leaves nothing to solve: every node is its own clique
+    if (!maxWeightCliquePartitionArena(weights, n, 1, &arena) || arena.count != n) passed = 0;
+    else freePartitionArena(&arena);
+
+    free(seen);
+    free(fixed);
+    free(kind);
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
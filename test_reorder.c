@@ -0,0 +1,205 @@
+/*
+ * Node reordering test: every order must be a permutation with its
+ * defining property (degeneracy: few earlier neighbours; RCM: a scrambled
+ * band comes back narrow; community: planted clusters come back
+ * contiguous), and solving through each order must return a valid
+ * partition in the caller's ids
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+unsigned int rng_state = 606;
+
+int next_random(int bound) {
+    rng_state = rng_state * 1103515245u + 12345u;
+    return (int)((rng_state >> 8) % (unsigned)bound);
+}
+
+int** empty_weights(int n) {
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) weights[i][j] = NO_EDGE;
+    }
+    return weights;
+}
+
+void free_weights(int** weights, int n) {
+    for (int i = 0; i < n - 1; i++) free(weights[i]);
+    free(weights);
+}
+
+void set_weight(int** weights, int u, int v, int w) {
+    if (u > v) {
+        int t = u;
+        u = v;
+        v = t;
+    }
+    weights[u][v - u - 1] = w;
+}
+
+int* scramble(int n) {
+    int* ids = (int*)malloc(n * sizeof(int));
+    for (int i = 0; i < n; i++) ids[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = next_random(i + 1);
+        int t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+    return ids;
+}
+
+// Builds perm for `order`, checks it is a permutation and fills inv
+int make_order(const Graph* g, int order, int* perm, int* inv) {
+    int ok = node_order(g, order, perm);
+    for (int i = 0; i < g->n; i++) inv[i] = -1;
+    for (int i = 0; ok && i < g->n; i++) {
+        if (perm[i] < 0 || perm[i] >= g->n || inv[perm[i]] >= 0) ok = 0;
+        else inv[perm[i]] = i;
+    }
+    return ok;
+}
+
+int main() {
+    printf("Testing node reordering...\n");
+    int passed = 1;
+    int n = 2000;
+    int* perm = (int*)malloc(n * sizeof(int));
+    int* inv = (int*)malloc(n * sizeof(int));
+
+    // Degeneracy: a 12-clique in a random tree has degeneracy 11
+    int** weights = empty_weights(n);
+    int* id = scramble(n);
+    for (int v = 1; v < n; v++) set_weight(weights, id[v], id[next_random(v)], 1 + next_random(9));
+    for (int a = 0; a < 12; a++) {
+        for (int b = a + 1; b < 12; b++) set_weight(weights, id[a * 7], id[b * 7], 5);
+    }
+    Graph g;
+    graph_build(&g, weights, n);
+    int ok = make_order(&g, MWCP_ORDER_DEGENERACY, perm, inv);
+    int most_earlier = 0;
+    for (int u = 0; ok && u < n; u++) {
+        NeighbourIter it;
+        int v, w, earlier = 0;
+        neighbour_iter_init(&it, &g, u, 0);
+        while (neighbour_iter_next(&it, &v, &w)) earlier += inv[v] < inv[u];
+        if (earlier > most_earlier) most_earlier = earlier;
+    }
+    printf("Degeneracy: permutation %s, most earlier neighbours %d (expected 11)\n", ok ? "ok" : "BAD", most_earlier);
+    if (!ok || most_earlier != 11) passed = 0;
+    graph_free(&g);
+    free_weights(weights, n);
+    free(id);
+
+    // RCM: a band of half-width 3 under scrambled ids
+    weights = empty_weights(n);
+    id = scramble(n);
+    for (int v = 0; v < n; v++) {
+        for (int d = 1; d <= 3 && v + d < n; d++) set_weight(weights, id[v], id[v + d], 1);
+    }
+    graph_build(&g, weights, n);
+    int before = 0, after = 0;
+    ok = make_order(&g, MWCP_ORDER_RCM, perm, inv);
+    for (int u = 0; ok && u < n; u++) {
+        NeighbourIter it;
+        int v, w;
+        neighbour_iter_init(&it, &g, u, u + 1);
+        while (neighbour_iter_next(&it, &v, &w)) {
+            if (v - u > before) before = v - u;
+            int gap = inv[u] > inv[v] ? inv[u] - inv[v] : inv[v] - inv[u];
+            if (gap > after) after = gap;
+        }
+    }
+    printf("RCM: permutation %s, bandwidth %d -> %d\n", ok ? "ok" : "BAD", before, after);
+    if (!ok || after > 6) passed = 0;
+    graph_free(&g);
+    free_weights(weights, n);
+    free(id);
+
+    // Community: 50 planted clusters of 40, positive inside, negative across
+    weights = empty_weights(n);
+    id = scramble(n);
+    for (int c = 0; c < 50; c++) {
+        for (int a = c * 40; a < c * 40 + 40; a++) {
+            for (int b = a + 1; b < c * 40 + 40; b++) {
+                if (next_random(100) < 50) set_weight(weights, id[a], id[b], 1 + next_random(20));
+            }
+            if (next_random(100) < 20) set_weight(weights, id[a], id[next_random(n)], -1 - next_random(20));
+        }
+    }
+    graph_build(&g, weights, n);
+    ok = make_order(&g, MWCP_ORDER_COMMUNITY, perm, inv);
+    int scattered = 0;
+    int* cluster = (int*)malloc(n * sizeof(int));
+    for (int v = 0; v < n; v++) cluster[id[v]] = v / 40;
+    for (int c = 0; ok && c < 50; c++) {
+        int lo = n, hi = -1;
+        for (int i = 0; i < n; i++) {
+            if (cluster[perm[i]] != c) continue;
+            if (i < lo) lo = i;
+            if (i > hi) hi = i;
+        }
+        scattered += hi - lo + 1 != 40;
+    }
+    printf("Community: permutation %s, clusters not contiguous: %d of 50\n", ok ? "ok" : "BAD", scattered);
+    if (!ok || scattered) passed = 0;
+    graph_free(&g);
+    free(cluster);
+    free(id);
+
+    // Solving through every order gives valid partitions in the caller's ids
+    int k = 5;
+    for (int order = MWCP_ORDER_NONE; order <= MWCP_ORDER_COMMUNITY; order++) {
+        PartitionArena arena;
+        if (!maxWeightCliquePartitionArenaOrdered(weights, n, k, order, &arena)) {
+            printf("Order %d: solve FAILED\n", order);
+            passed = 0;
+            continue;
+        }
+        int* seen = (int*)calloc(n, sizeof(int));
+        long long total = 0;
+        int valid = arena.offsets[arena.count] == n;
+        for (int c = 0; c < arena.count && valid; c++) {
+            const int* members = arena.members + arena.offsets[c];
+            int size = arena.offsets[c + 1] - arena.offsets[c];
+            if (size < 1 || size > k) valid = 0;
+            for (int i = 0; i < size && valid; i++) {
+                if (seen[members[i]]++) valid = 0;
+                // Mapped-back cliques list their members ascending
+                if (order != MWCP_ORDER_NONE && i > 0 && members[i - 1] > members[i]) valid = 0;
+                for (int j = i + 1; j < size; j++) {
+                    int w = safe_get_weight(weights, n, members[i], members[j]);
+                    if (w == NO_EDGE) valid = 0;
+                    total += w;
+                }
+            }
+        }
+        for (int v = 0; v < n; v++) {
+            if (seen[v] != 1) valid = 0;
+        }
+        printf("Order %d: %d cliques, objective %.4f, valid: %s\n", order, arena.count, (double)total / n,
+               valid ? "yes" : "no");
+        if (!valid) passed = 0;
+        free(seen);
+        freePartitionArena(&arena);
+    }
+    PartitionArena arena;
+    if (maxWeightCliquePartitionArenaOrdered(weights, n, k, 7, &arena)) {
+        printf("Unknown order ACCEPTED\n");
+        freePartitionArena(&arena);
+        passed = 0;
+    }
+    free_weights(weights, n);
+    free(perm);
+    free(inv);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
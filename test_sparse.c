@@ -0,0 +1,149 @@
+/*
+ * Sparse backend test: low-density inputs must select the CSR layout with no
+ * adjacency bitset, read back the same weights and adjacency, and solve to
+ * exactly the partition the dense layout gives; a 50k-node graph built
+ * straight into CSR form must solve without any n x n structure
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+// Same graph forced into the dense layout
+int build_dense(Graph* g, int** weights, int n) {
+    if (!graph_alloc(g, n)) return 0;
+    for (int u = 0; u < n - 1; u++) {
+        int* dst = graph_upper_row(g, u);
+        for (int j = 0; j < n - 1 - u; j++) {
+            dst[j] = weights[u][j];
+        }
+        graph_finish_row(g, u, 0);
+    }
+    return 1;
+}
+
+/*
+ * Every node links to a few random higher ids, so rows arrive in ascending
+ * (u, v) order; a bitset or per-clique mask for this n would take ~312 MB
+ */
+int check_large(int n, int per_node) {
+    size_t* degree = (size_t*)calloc((size_t)n + 1, sizeof(size_t));
+    int* targets = (int*)malloc((size_t)n * per_node * sizeof(int));
+    unsigned int seed = 91;
+    for (int u = 0; u < n; u++) {
+        int prev = u;
+        for (int j = 0; j < per_node; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int v = prev + 1 + (int)((seed >> 16) % 40);
+            targets[u * per_node + j] = v < n ? v : -1;
+            if (v >= n) continue;
+            degree[u]++;
+            degree[v]++;
+            prev = v;
+        }
+    }
+    Graph g;
+    int ok = graph_alloc_sparse(&g, n, degree);
+    for (int u = 0; ok && u < n; u++) {
+        for (int j = 0; j < per_node; j++) {
+            int v = targets[u * per_node + j];
+            if (v < 0) break;
+            seed = seed * 1103515245u + 12345u;
+            graph_sparse_append(&g, degree, u, v, (int)((seed >> 4) % 61) - 20);
+        }
+    }
+
+    PartitionArena arena;
+    double start = clock_seconds();
+    ok = ok && g.adj.bits == NULL && solve_graph(&g, 5, &arena);
+    double elapsed = clock_seconds() - start;
+    int covered = 0, valid = ok;
+    for (int c = 0; ok && c < arena.count; c++) {
+        int first = arena.offsets[c], end = arena.offsets[c + 1];
+        if (end - first > 5) valid = 0;
+        for (int i = first; i < end; i++) {
+            covered++;
+            for (int j = i + 1; j < end; j++) {
+                if (!graph_adjacent(&g, arena.members[i], arena.members[j])) valid = 0;
+            }
+        }
+    }
+    printf("Large CSR graph: n=%d, %zu edges, %d cliques, valid %s, %.2fs\n", n, ok ? g.nbr_start[n] / 2 : 0,
+           ok ? arena.count : 0, valid && covered == n ? "yes" : "no", elapsed);
+    if (ok) freePartitionArena(&arena);
+    graph_free(&g);
+    free(degree);
+    free(targets);
+    return valid && covered == n;
+}
+
+int main() {
+    printf("Testing sparse graph backend...\n");
+    int passed = 1;
+
+    int n = 1500, k = 5;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 77;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 1000);
+            weights[i][j] = r < 15 ? (int)((seed >> 4) % 61) - 20 : NO_EDGE;
+        }
+    }
+
+    Graph sparse, dense;
+    graph_build(&sparse, weights, n);
+    build_dense(&dense, weights, n);
+    printf("Layout chosen: %s, bitset %s\n", sparse.layout == GRAPH_SPARSE ? "sparse" : "dense",
+           sparse.adj.bits ? "allocated" : "none");
+    if (sparse.layout != GRAPH_SPARSE || sparse.adj.bits) passed = 0;
+
+    int mismatches = 0;
+    long long degree_sum = 0;
+    for (int u = 0; u < n; u++) {
+        degree_sum += graph_degree(&sparse, u);
+        if (graph_degree(&sparse, u) != graph_degree(&dense, u)) mismatches++;
+        for (int v = 0; v < n; v++) {
+            if (u == v) continue;
+            if (graph_weight(&sparse, u, v) != graph_weight(&dense, u, v) ||
+                graph_adjacent(&sparse, u, v) != graph_adjacent(&dense, u, v)) {
+                mismatches++;
+            }
+        }
+    }
+    printf("Edges: %lld, mismatches: %d\n", degree_sum / 2, mismatches);
+    if (mismatches) passed = 0;
+
+    // Both layouts must drive the pipeline through identical decisions
+    PartitionArena from_sparse, from_dense;
+    int ok_sparse = solve_graph(&sparse, k, &from_sparse);
+    int ok_dense = solve_graph(&dense, k, &from_dense);
+    int same = ok_sparse && ok_dense && from_sparse.count == from_dense.count;
+    for (int i = 0; same && i <= from_sparse.count; i++) {
+        same = from_sparse.offsets[i] == from_dense.offsets[i];
+    }
+    for (int v = 0; same && v < n; v++) {
+        same = from_sparse.members[v] == from_dense.members[v];
+    }
+    printf("Sparse and dense partitions identical: %s (%d cliques)\n", same ? "yes" : "no", from_sparse.count);
+    if (!same) passed = 0;
+    if (ok_sparse) freePartitionArena(&from_sparse);
+    if (ok_dense) freePartitionArena(&from_dense);
+
+    graph_free(&sparse);
+    graph_free(&dense);
+    if (!check_large(50000, 4)) passed = 0;
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * Tabu search test: on a mixed-sign graph the result must be a valid
+ * partition no worse than the pipeline alone, reproducible for a seed,
+ * and within the time budget; a search run directly on a working
+ * partition must leave its bookkeeping exact after thousands of moves
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+// Sum of intra-clique weights, or -1 if the partition is invalid
+long long partition_weight(int** weights, int n, int k, int** partition, int* clique_sizes, int partition_size) {
+    int* seen = (int*)calloc(n, sizeof(int));
+    long long total = 0;
+    int valid = 1;
+    for (int c = 0; c < partition_size; c++) {
+        if (clique_sizes[c] < 1 || clique_sizes[c] > k) valid = 0;
+        for (int i = 0; i < clique_sizes[c]; i++) {
+            int u = partition[c][i];
+            if (seen[u]++) valid = 0;
+            for (int j = i + 1; j < clique_sizes[c]; j++) {
+                int w = safe_get_weight(weights, n, u, partition[c][j]);
+                if (w == NO_EDGE) valid = 0;
+                total += w;
+            }
+        }
+    }
+    for (int v = 0; v < n; v++) {
+        if (seen[v] != 1) valid = 0;
+    }
+    free(seen);
+    return valid ? total : -1;
+}
+
+void free_partition(int** partition, int* clique_sizes, int partition_size) {
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+}
+
+int main() {
+    printf("Testing tabu search...\n");
+    int passed = 1;
+
+    // Mixed signs: mostly small positive weights, a fifth strongly negative
+    int n = 500, k = 5;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 31337;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 20 ? 1 + r % 10 : r < 25 ? -10 - r : NO_EDGE;
+        }
+    }
+
+    int plain_size;
+    int* plain_sizes;
+    int** plain = maxWeightCliquePartition(weights, n, k, &plain_size, &plain_sizes);
+    long long plain_weight = partition_weight(weights, n, k, plain, plain_sizes, plain_size);
+    free_partition(plain, plain_sizes, plain_size);
+
+    TabuOptions options;
+    options.max_iterations = 2000;
+    options.time_limit = 0;
+    options.tenure = 0;
+    options.seed = 5;
+    long long weight[2];
+    int* labels[2];
+    for (int run = 0; run < 2; run++) {
+        int size;
+        int* sizes;
+        TabuResult result;
+        int** partition = maxWeightCliquePartitionTabu(weights, n, k, &size, &sizes, &options, &result);
+        if (!partition) {
+            printf("Test FAILED: tabu solve returned NULL\n");
+            return 1;
+        }
+        weight[run] = partition_weight(weights, n, k, partition, sizes, size);
+        labels[run] = (int*)malloc(n * sizeof(int));
+        for (int c = 0; c < size; c++) {
+            for (int i = 0; i < sizes[c]; i++) labels[run][partition[c][i]] = c;
+        }
+        printf("Run %d: weight %lld (pipeline %lld), objective %.4f -> %.4f, best at iteration %lld of %lld\n",
+               run, weight[run], plain_weight, result.start_objective, result.objective,
+               result.best_iteration, result.iterations);
+        if (weight[run] < 0 || weight[run] < plain_weight) passed = 0;
+        if (weight[run] != (long long)(result.objective * n + 0.5)) passed = 0;
+        if (result.iterations != options.max_iterations) passed = 0;
+        free_partition(partition, sizes, size);
+    }
+    int differ = weight[0] != weight[1];
+    for (int v = 0; v < n; v++) differ += labels[0][v] != labels[1][v];
+    printf("Same seed, differences: %d\n", differ);
+    if (differ) passed = 0;
+    free(labels[0]);
+    free(labels[1]);
+
+    // A time limit stops an effectively unbounded iteration budget
+    options.max_iterations = 1 << 30;
+    options.time_limit = 0.2;
+    int size;
+    int* sizes;
+    TabuResult result;
+    double start = clock_seconds();
+    int** partition = maxWeightCliquePartitionTabu(weights, n, k, &size, &sizes, &options, &result);
+    double elapsed = clock_seconds() - start;
+    long long timed = partition ? partition_weight(weights, n, k, partition, sizes, size) : -1;
+    printf("Time limit 0.2 s: %.2f s, %lld iterations, weight %lld\n", elapsed, result.iterations, timed);
+    if (timed < plain_weight || elapsed > 2.0 + LOCAL_SEARCH_TIME_LIMIT) passed = 0;
+    if (partition) free_partition(partition, sizes, size);
+
+    // Bookkeeping after the walk: clique weights and fits against a recount
+    Graph g;
+    WorkPartition wp;
+    SeedSet seeds;
+    LocalSearchOptions ls;
+    ls.max_passes = LOCAL_SEARCH_MAX_PASSES;
+    ls.time_limit = 0;
+    graph_build(&g, weights, n);
+    work_partition_init(&wp, &g, k);
+    seed_set_build(&seeds, &g, k, SEED_EDGES_LAZY, NULL);
+    run_pipeline(&wp, &seeds, &ls);
+    seed_set_free(&seeds);
+    options.max_iterations = 3000;
+    options.time_limit = 0;
+    options.tenure = TABU_TENURE;
+    int* best = (int*)malloc(n * sizeof(int));
+    if (!phase_tabu_search(&wp, &options, best, NULL)) passed = 0;
+    int broken = 0;
+    for (int c = 0; c < wp.count; c++) {
+        long long recount = 0;
+        if (wp.size[c] > k) broken++;
+        for (int i = 0; i < wp.size[c]; i++) {
+            for (int j = i + 1; j < wp.size[c]; j++) {
+                int w = safe_get_weight(weights, n, wp.members[c][i], wp.members[c][j]);
+                if (w == NO_EDGE) broken++;
+                recount += w;
+            }
+        }
+        if (recount != wp.weight[c]) broken++;
+    }
+    printf("Working partition after 3000 moves: %d inconsistencies\n", broken);
+    if (broken) passed = 0;
+    free(best);
+    work_partition_free(&wp);
+    graph_free(&g);
+
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/*
+ * Text loader test: a generated upper-triangular file must load into the
+ * same graph as the in-memory matrix, malformed files must be rejected, and
+ * solving from the file must match solving from the matrix
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NO_EDGE -9999
+
+// Include the implementation
+#include "maxweight_clique_partition.c"
+
+#define INPUT_FILE "test_text_input.tmp"
+
+// Write the matrix with mixed separators, CRLF endings and blank lines
+void write_matrix(const char* path, int** weights, int n) {
+    FILE* f = fopen(path, "w");
+    fprintf(f, "\n");
+    for (int i = 0; i < n - 1; i++) {
+        for (int j = 0; j < n - 1 - i; j++) {
+            fprintf(f, j == 0 ? " %d" : (j % 3 ? "\t%d" : "   %d"), weights[i][j]);
+        }
+        fprintf(f, i % 2 ? "\r\n" : " \n");
+    }
+    fprintf(f, "\n\n");
+    fclose(f);
+}
+
+void write_text(const char* path, const char* text) {
+    FILE* f = fopen(path, "w");
+    fputs(text, f);
+    fclose(f);
+}
+
+void free_partition(int** partition, int* clique_sizes, int partition_size) {
+    for (int i = 0; i < partition_size; i++) {
+        free(partition[i]);
+    }
+    free(partition);
+    free(clique_sizes);
+}
+
+int main() {
+    printf("Testing text input loader...\n");
+    int passed = 1;
+
+    int n = 600, k = 4;
+    int** weights = (int**)malloc((n - 1) * sizeof(int*));
+    unsigned int seed = 31;
+    for (int i = 0; i < n - 1; i++) {
+        weights[i] = (int*)malloc((n - 1 - i) * sizeof(int));
+        for (int j = 0; j < n - 1 - i; j++) {
+            seed = seed * 1103515245u + 12345u;
+            int r = (int)((seed >> 16) % 100);
+            weights[i][j] = r < 25 ? (int)((seed >> 4) % 2001) - 1000 : NO_EDGE;
+        }
+    }
+    write_matrix(INPUT_FILE, weights, n);
+
+    // Loaded graph must match the matrix entry for entry
+    Graph loaded, built;
+    if (!graph_load_text(&loaded, INPUT_FILE, 4)) {
+        printf("Load FAILED\n");
+        return 1;
+    }
+    graph_build(&built, weights, n);
+    int mismatches = loaded.n == n ? 0 : 1;
+    for (int u = 0; u < n && !mismatches; u++) {
+        for (int v = 0; v < n; v++) {
+            if (u == v) continue;
+            if (graph_weight(&loaded, u, v) != graph_weight(&built, u, v) ||
+                graph_adjacent(&loaded, u, v) != graph_adjacent(&built, u, v)) {
+                mismatches++;
+            }
+        }
+    }
+    printf("Loaded n=%d, mismatches: %d\n", loaded.n, mismatches);
+    if (mismatches) passed = 0;
+    graph_free(&loaded);
+    graph_free(&built);
+
+    // Solving from the file is the same as solving from the matrix
+    int file_n, file_size, mem_size;
+    int *file_sizes, *mem_sizes;
+    int** from_file = maxWeightCliquePartitionFromFile(INPUT_FILE, k, &file_n, &file_size, &file_sizes);
+    int** from_mem = maxWeightCliquePartition(weights, n, k, &mem_size, &mem_sizes);
+    int same = from_file && from_mem && file_n == n && file_size == mem_size;
+    for (int c = 0; same && c < mem_size; c++) {
+        same = file_sizes[c] == mem_sizes[c];
+        for (int i = 0; same && i < mem_sizes[c]; i++) {
+            same = from_file[c][i] == from_mem[c][i];
+        }
+    }
+    printf("File and matrix partitions identical: %s\n", same ? "yes" : "no");
+    if (!same) passed = 0;
+    if (from_file) free_partition(from_file, file_sizes, file_size);
+    if (from_mem) free_partition(from_mem, mem_sizes, mem_size);
+
+    // Sample input from Problem.md, then malformed inputs
+    const char* cases[] = {
+        "3   5   -9999   1\n4   -9999   5\n-9999   6\n7\n",
+        "3 5 -9999 1\n4 -9999\n-9999 6\n7\n",       // short row
+        "3 5 -9999 1\n4 -9999 5 8\n-9999 6\n7\n",   // long row
+        "3 5 -99x9 1\n4 -9999 5\n-9999 6\n7\n",     // bad token
+        "3 5 -9999 1\n4 -9999 5\n-9999 6\n99999999999\n"  // overflow
+    };
+    for (int t = 0; t < 5; t++) {
+        write_text(INPUT_FILE, cases[t]);
+        Graph g;
+        int ok = graph_load_text(&g, INPUT_FILE, 2);
+        int expected = t == 0;
+        if (ok) {
+            if (g.n != 5 || graph_weight(&g, 0, 2) != 5 || graph_weight(&g, 4, 3) != 7 ||
+                graph_adjacent(&g, 0, 3)) {
+                expected = 0;
+            }
+            graph_free(&g);
+        }
+        printf("Case %d: %s\n", t, ok == expected ? "ok" : "WRONG");
+        if (ok != expected) passed = 0;
+    }
+
+    remove(INPUT_FILE);
+    if (maxWeightCliquePartitionFromFile(INPUT_FILE, k, &file_n, &file_size, &file_sizes) != NULL) {
+        printf("Missing file was not rejected\n");
+        passed = 0;
+    }
+
+    for (int i = 0; i < n - 1; i++) {
+        free(weights[i]);
+    }
+    free(weights);
+
+    printf(passed ? "Test PASSED\n" : "Test FAILED\n");
+    return passed ? 0 : 1;
+}